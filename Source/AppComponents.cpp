@@ -130,16 +130,16 @@ void OSCActionConstructor::MainComp::findEditThisActionsTemplate(const CueOSCAct
     // Verify details
     // If template is COMMAND
     if (editThisAction.oat == OAT_COMMAND) {
-        if (auto *optVal = std::get_if<OptionParam>(&editThisAction.oatCommandOSCArgumentTemplate)) {
+        if (editThisAction.argumentTemplate.getOptionParam()) {
             // Not supported!
             return;
-        } else if (auto *enumParam = std::get_if<EnumParam>(&editThisAction.oatCommandOSCArgumentTemplate)) {
+        } else if (auto *enumParam = editThisAction.argumentTemplate.getEnumParam()) {
             if (enumParam->isSimilar(it->second.ENUMPARAM)) {
                 // We've found it!
                 currentTemplateCopy = std::make_unique<XM32Template>(it->second);
             }
             return;
-        } else if (auto *nonIter = std::get_if<NonIter>(&editThisAction.oatCommandOSCArgumentTemplate)) {
+        } else if (auto *nonIter = editThisAction.argumentTemplate.getNonIter()) {
             if (nonIter->isSimilar(it->second.NONITER)) {
                 // Found it!
                 currentTemplateCopy = std::make_unique<XM32Template>(it->second);
@@ -147,7 +147,7 @@ void OSCActionConstructor::MainComp::findEditThisActionsTemplate(const CueOSCAct
             return;
         }
         // Otherwise, we expect a FADE_COMMAND
-    } else if (editThisAction.oscArgumentTemplate.isSimilar(it->second.NONITER)) {
+    } else if (editThisAction.getFadeTemplate().isSimilar(it->second.NONITER)) {
         // We've found the action!
         currentTemplateCopy = std::make_unique<XM32Template>(it->second);
         return;
@@ -881,8 +881,8 @@ void OSCActionConstructor::MainComp::uponNewInputMethodSelected(bool updateFirst
                             break;
                         }
                         case STRING: {
-                            if (currentTemplateCopy->NONITER.valueIsValid(inputValues.first.stringValue)) {
-                                textInputs.first->setText(String(inputValues.first.stringValue));
+                            if (currentTemplateCopy->NONITER.valueIsValid(inputValues.first.stringValue.toStdString())) {
+                                textInputs.first->setText(String(inputValues.first.stringValue.toStdString()));
                             }
                         }
                         default:
@@ -990,8 +990,8 @@ void OSCActionConstructor::MainComp::uponNewInputMethodSelected(bool updateFirst
                             break;
                         }
                         case STRING: {
-                            if (currentTemplateCopy->NONITER.valueIsValid(inputValues.second.stringValue)) {
-                                textInputs.second->setText(String(inputValues.second.stringValue));
+                            if (currentTemplateCopy->NONITER.valueIsValid(inputValues.second.stringValue.toStdString())) {
+                                textInputs.second->setText(String(inputValues.second.stringValue.toStdString()));
                             }
                             break;
                         }
@@ -1060,7 +1060,7 @@ void OSCActionConstructor::MainComp::uponValueStorerExternallyChanged(bool updat
                 } else if (inputValues.first._meta_PARAMTYPE == _GENERIC_FLOAT) {
                     textInputs.first->setText(String(inputValues.first.floatValue));
                 } else
-                    textInputs.first->setText(String(inputValues.first.stringValue));
+                    textInputs.first->setText(String(inputValues.first.stringValue.toStdString()));
                 break;
             }
             case BUTTON_ARRAY:
@@ -1115,7 +1115,7 @@ void OSCActionConstructor::MainComp::uponValueStorerExternallyChanged(bool updat
                 } else if (inputValues.second._meta_PARAMTYPE == _GENERIC_FLOAT) {
                     textInputs.second->setText(String(inputValues.second.floatValue));
                 } else
-                    textInputs.second->setText(String(inputValues.second.stringValue));
+                    textInputs.second->setText(String(inputValues.second.stringValue.toStdString()));
                 break;
             }
             case BUTTON_ARRAY:
@@ -1558,7 +1558,7 @@ bool OSCActionConstructor::MainComp::currentActionIsValid() const {
                     break;
                 }
                 case STRING: {
-                    if (!argTemplate.valueIsValid(pathLabelFormattedValues.at(i).stringValue))
+                    if (!argTemplate.valueIsValid(pathLabelFormattedValues.at(i).stringValue.toStdString()))
                         lastWasInvalid = true;
                     break;
                 }
@@ -1606,7 +1606,7 @@ bool OSCActionConstructor::MainComp::currentActionIsValid() const {
                 break;
             }
             case STRING:
-                if (inputValues.first._meta_PARAMTYPE != STRING || !ni.valueIsValid(inputValues.first.stringValue))
+                if (inputValues.first._meta_PARAMTYPE != STRING || !ni.valueIsValid(inputValues.first.stringValue.toStdString()))
                     return false;
                 break;
             default:
@@ -1641,7 +1641,7 @@ bool OSCActionConstructor::MainComp::currentActionIsValid() const {
                     break;
                 }
                 case STRING:
-                    if (inputValues.second._meta_PARAMTYPE != STRING || !ni.valueIsValid(inputValues.second.stringValue))
+                    if (inputValues.second._meta_PARAMTYPE != STRING || !ni.valueIsValid(inputValues.second.stringValue.toStdString()))
                         return false;
                     break;
                 default:
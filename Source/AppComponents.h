@@ -1077,7 +1077,7 @@ public:
                             valueText = String(currentAction.argument.intValue) + " (i)";
                             break;
                         case STRING:
-                            valueText = String(currentAction.argument.stringValue) + " (s)";
+                            valueText = String(currentAction.argument.stringValue.toStdString()) + " (s)";
                             break;
                         case _GENERIC_FLOAT:
                             valueText = String(currentAction.argument.floatValue) + " (f)";
@@ -1161,13 +1161,13 @@ public:
                 switch (action.oat) {
                     case OAT_COMMAND: {
                         actions.emplace_back(new CueOSCAction(action.oscAddress,
-                                                              action.oatCommandOSCArgumentTemplate,
+                                                              action.argumentTemplate,
                                                               action.argument, action.argumentTemplateID));
                         break;
                     }
                     case OAT_FADE: {
                         actions.emplace_back(new CueOSCAction(action.oscAddress, action.fadeTime,
-                                                              action.oscArgumentTemplate, action.startValue,
+                                                              action.argumentTemplate, action.startValue,
                                                               action.endValue, action.argumentTemplateID));
                         break;
                     }
@@ -1261,13 +1261,13 @@ public:
             switch (compiledCCA.oat) {
                 case OAT_COMMAND: {
                     actions[it->second].reset(new CueOSCAction(compiledCCA.oscAddress,
-                                                               compiledCCA.oatCommandOSCArgumentTemplate,
+                                                               compiledCCA.argumentTemplate,
                                                                compiledCCA.argument, compiledCCA.argumentTemplateID));
                     break;
                 }
                 case OAT_FADE:{
                     actions[it->second].reset(new CueOSCAction(compiledCCA.oscAddress, compiledCCA.fadeTime,
-                        compiledCCA.oscArgumentTemplate, compiledCCA.startValue, compiledCCA.endValue, compiledCCA.argumentTemplateID));
+                        compiledCCA.argumentTemplate, compiledCCA.startValue, compiledCCA.endValue, compiledCCA.argumentTemplateID));
                     break;
                 }
             }
@@ -0,0 +1,431 @@
+/*
+  ==============================================================================
+
+    AutosaveJournal.cpp
+    Created: 17 Oct 2026 6:03:52pm
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#include "AutosaveJournal.h"
+
+
+namespace {
+    constexpr char journalMagic[8] = {'X', 'M', '3', '2', 'J', 'R', 'N', 'L'};
+    constexpr int journalVersion = 1;
+    constexpr size_t journalHeaderSize = sizeof(journalMagic) + sizeof(int32);
+
+    // A record is its body's size (int32), the body's checksum (int32) and the body: a RecordType byte, then
+    // CUE_INSERTED: the index (int64) and the cue as a one-cue show file (see ShowFile)
+    // CUE_ERASED: the index (int64)
+    // CUE_MOVED: the old and new indexes (int64 each)
+    // All little endian.
+    enum RecordType : uint8 { CUE_INSERTED = 1, CUE_ERASED, CUE_MOVED };
+    constexpr size_t recordFrameSize = 2 * sizeof(int32);
+
+    // FNV-1a. Only needs to catch torn and partly written records, not tampering.
+    uint32 checksum(const void *data, size_t size) {
+        uint32 hash = 2166136261u;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ static_cast<const uint8 *>(data)[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    MemoryBlock frameRecord(const MemoryOutputStream &body) {
+        MemoryOutputStream record(recordFrameSize + body.getDataSize());
+        record.writeInt(static_cast<int>(body.getDataSize()));
+        record.writeInt(static_cast<int>(checksum(body.getData(), body.getDataSize())));
+        record.write(body.getData(), body.getDataSize());
+        return record.getMemoryBlock();
+    }
+
+    // Parses a generation out of a name like "snapshot-12.xm32show". Returns false for any other name.
+    bool parseGeneration(const File &file, const String &prefix, uint64 &fileGeneration) {
+        const auto name = file.getFileNameWithoutExtension();
+        if (!name.startsWith(prefix) || !name.substring(prefix.length()).containsOnly("0123456789") ||
+            name.length() == prefix.length()) {
+            return false;
+        }
+        fileGeneration = static_cast<uint64>(name.substring(prefix.length()).getLargeIntValue());
+        return true;
+    }
+}
+
+
+AutosaveJournal::AutosaveJournal(const File &directory, CurrentCueInfoVector &cciVector,
+                                 const ActiveShowOptions &activeShowOptions):
+    Thread("Autosave Journal"), directory(directory), cciVector(cciVector), activeShowOptions(activeShowOptions) {}
+
+
+AutosaveJournal::~AutosaveJournal() {
+    if (started) {
+        cciVector.removeMutationListener(this);
+    }
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000); // run() writes whatever is pending before it returns
+}
+
+
+void AutosaveJournal::start() {
+    if (started) {
+        jassertfalse; // Already journalling
+        return;
+    }
+    if (!directory.createDirectory()) {
+        fail("Couldn't create the autosave folder " + directory.getFullPathName());
+        return;
+    }
+    // Carry on from any generation already on disk, so the first snapshot replaces it rather than being older
+    uint64 newest;
+    if (findNewestGeneration(directory, newest)) {
+        generation = newest;
+    }
+    started = true;
+    compact();
+    cciVector.addMutationListener(this);
+    startThread();
+}
+
+
+void AutosaveJournal::discard() {
+    if (started) {
+        cciVector.removeMutationListener(this);
+        started = false;
+    }
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000);
+    journal.reset(); // The thread has stopped, so this is safe to touch
+    deleteGenerationsBefore(std::numeric_limits<uint64>::max());
+}
+
+
+void AutosaveJournal::compact() {
+    if (!started) {
+        return;
+    }
+    Snapshot snapshot{{}, activeShowOptions.showName, activeShowOptions.showDescription};
+    snapshot.cues.reserve(cciVector.getSize());
+    for (const auto &cci: cciVector) {
+        snapshot.cues.push_back(cci);
+    }
+    recordsSinceSnapshot = 0;
+    queueSnapshot(++generation, std::move(snapshot));
+}
+
+
+void AutosaveJournal::cueInserted(size_t index, const CurrentCueInfo &cci) {
+    MemoryOutputStream body;
+    body.writeByte(static_cast<char>(CUE_INSERTED));
+    body.writeInt64(static_cast<int64>(index));
+    ShowFile::write(body, 1, [&cci](size_t) -> const CurrentCueInfo & { return cci; }, {}, {});
+    queueRecord(frameRecord(body));
+}
+
+
+void AutosaveJournal::cueErased(size_t index) {
+    MemoryOutputStream body;
+    body.writeByte(static_cast<char>(CUE_ERASED));
+    body.writeInt64(static_cast<int64>(index));
+    queueRecord(frameRecord(body));
+}
+
+
+void AutosaveJournal::cueMoved(size_t oldIndex, size_t newIndex) {
+    MemoryOutputStream body;
+    body.writeByte(static_cast<char>(CUE_MOVED));
+    body.writeInt64(static_cast<int64>(oldIndex));
+    body.writeInt64(static_cast<int64>(newIndex));
+    queueRecord(frameRecord(body));
+}
+
+
+void AutosaveJournal::cuesReset() {
+    compact(); // A new show has nothing to do with the old journal
+}
+
+
+void AutosaveJournal::queueRecord(const MemoryBlock &record) {
+    if (disabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (pending.empty() || pending.back().type != PendingWrite::RECORDS) {
+            pending.push_back({PendingWrite::RECORDS, generation, {}, {}});
+        }
+        pending.back().data.append(record.getData(), record.getSize());
+    }
+    notify();
+    if (++recordsSinceSnapshot >= compactAfterRecords) {
+        compact();
+    }
+}
+
+
+void AutosaveJournal::queueSnapshot(uint64 snapshotGeneration, Snapshot snapshot) {
+    if (disabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::vector<PendingWrite> superseded; // Freed once the lock is released, so the writer isn't kept waiting
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        // Records queued for older generations are already in the snapshot, so they needn't be written at all
+        superseded.swap(pending);
+        pending.push_back({PendingWrite::SNAPSHOT, snapshotGeneration, {}, std::move(snapshot)});
+    }
+    notify();
+}
+
+
+void AutosaveJournal::run() {
+    while (!threadShouldExit()) {
+        wait(-1);
+        // Let the rest of a burst of edits (e.g., a bulk edit) arrive, so they share one write and one sync
+        if (!threadShouldExit()) {
+            sleep(groupCommitWindowMs);
+        }
+        writePending();
+    }
+    writePending();
+}
+
+
+void AutosaveJournal::writePending() {
+    std::vector<PendingWrite> toWrite;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        toWrite.swap(pending);
+    }
+    bool journalWritten = false;
+    for (const auto &write: toWrite) {
+        if (disabled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (write.type == PendingWrite::SNAPSHOT) {
+            if (journal != nullptr && journalWritten) {
+                journal->flush();
+            }
+            journalWritten = false;
+            if (!writeSnapshot(write.generation, write.snapshot)) {
+                fail("Couldn't write the autosave snapshot " + getSnapshotFile(write.generation).getFullPathName());
+            }
+            continue;
+        }
+        if (journal == nullptr || journalGeneration != write.generation) {
+            continue; // Their generation's snapshot couldn't be written, so neither can they
+        }
+        journal->write(write.data.getData(), write.data.getSize());
+        journalWritten = true;
+    }
+    // One sync for everything written above. FileOutputStream::flush() syncs the file to disk.
+    if (journal != nullptr && journalWritten) {
+        journal->flush();
+        if (journal->getStatus().failed()) {
+            fail("Couldn't write to the autosave journal: " + journal->getStatus().getErrorMessage());
+        }
+    }
+}
+
+
+bool AutosaveJournal::writeSnapshot(uint64 snapshotGeneration, const Snapshot &snapshot) {
+    journal.reset();
+    TemporaryFile temporaryFile(getSnapshotFile(snapshotGeneration));
+    {
+        FileOutputStream out(temporaryFile.getFile());
+        if (out.failedToOpen()) {
+            return false;
+        }
+        const auto result = ShowFile::write(out, snapshot.cues.size(),
+                                            [&snapshot](size_t index) -> const CurrentCueInfo & {
+                                                return snapshot.cues[index];
+                                            }, snapshot.showName, snapshot.showDescription);
+        if (result.failed()) {
+            return false;
+        }
+        out.flush();
+        if (out.getStatus().failed()) {
+            return false;
+        }
+    }
+    if (!temporaryFile.overwriteTargetFileWithTemporary()) {
+        return false;
+    }
+
+    const auto journalFile = getJournalFile(snapshotGeneration);
+    journalFile.deleteFile();
+    journal = std::make_unique<FileOutputStream>(journalFile);
+    if (journal->failedToOpen()) {
+        journal.reset();
+        return false;
+    }
+    journal->write(journalMagic, sizeof(journalMagic));
+    journal->writeInt(journalVersion);
+    journal->flush();
+    journalGeneration = snapshotGeneration;
+
+    // Only now that the new generation is on disk can the old one go
+    deleteGenerationsBefore(snapshotGeneration);
+    return true;
+}
+
+
+void AutosaveJournal::deleteGenerationsBefore(uint64 firstKept) const {
+    for (const auto &file: directory.findChildFiles(File::findFiles, false)) {
+        uint64 fileGeneration;
+        if ((parseGeneration(file, "snapshot-", fileGeneration) || parseGeneration(file, "journal-", fileGeneration)) &&
+            fileGeneration < firstKept) {
+            file.deleteFile();
+        }
+    }
+}
+
+
+void AutosaveJournal::fail(const String &reason) {
+    if (disabled.exchange(true)) {
+        return;
+    }
+    DBG("Autosave disabled: " + reason);
+    journal.reset(); // Only reached from start(), before the writer runs, or from the writer itself
+    if (onFailure) {
+        onFailure(reason);
+    }
+}
+
+
+File AutosaveJournal::setAside(const File &directory) {
+    const auto folder = directory.getNonexistentChildFile(
+        "Unrecovered " + Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S"), {}, false);
+    if (!folder.createDirectory()) {
+        return {};
+    }
+    for (const auto &file: directory.findChildFiles(File::findFiles, false)) {
+        uint64 fileGeneration;
+        if ((parseGeneration(file, "snapshot-", fileGeneration) || parseGeneration(file, "journal-", fileGeneration)) &&
+            !file.moveFileTo(folder.getChildFile(file.getFileName()))) {
+            return {};
+        }
+    }
+    return folder;
+}
+
+
+File AutosaveJournal::getSnapshotFile(const File &directory, uint64 fileGeneration) {
+    return directory.getChildFile("snapshot-" + String(fileGeneration) + ".xm32show");
+}
+
+
+File AutosaveJournal::getJournalFile(const File &directory, uint64 fileGeneration) {
+    return directory.getChildFile("journal-" + String(fileGeneration) + ".log");
+}
+
+
+bool AutosaveJournal::findNewestGeneration(const File &directory, uint64 &newest) {
+    bool found = false;
+    for (const auto &file: directory.findChildFiles(File::findFiles, false, "snapshot-*.xm32show")) {
+        uint64 fileGeneration;
+        if (parseGeneration(file, "snapshot-", fileGeneration) && (!found || fileGeneration > newest)) {
+            newest = fileGeneration;
+            found = true;
+        }
+    }
+    return found;
+}
+
+
+bool AutosaveJournal::hasAutosave(const File &directory) {
+    uint64 newest;
+    return findNewestGeneration(directory, newest);
+}
+
+
+Result AutosaveJournal::recover(const File &directory, std::vector<CurrentCueInfo> &recoveredCCIs, String &showName,
+                                String &showDescription) {
+    // The newest snapshot is always complete (it's only renamed into place once written)
+    uint64 newest;
+    if (!findNewestGeneration(directory, newest)) {
+        return Result::fail("No autosave to recover");
+    }
+
+    ShowFile snapshot;
+    if (const auto result = snapshot.open(getSnapshotFile(directory, newest)); result.failed()) {
+        return result;
+    }
+    size_t droppedActions;
+    recoveredCCIs = snapshot.buildCues(droppedActions);
+    if (droppedActions > 0) {
+        // Written by the journal, so a bad record means the file itself is damaged
+        recoveredCCIs.clear();
+        return Result::fail("The autosave is damaged: " + String(static_cast<int64>(droppedActions)) +
+                            " of its actions couldn't be read");
+    }
+    showName = snapshot.getShowName();
+    showDescription = snapshot.getShowDescription();
+
+    MemoryBlock journalData;
+    if (!getJournalFile(directory, newest).loadFileAsData(journalData) || journalData.getSize() < journalHeaderSize ||
+        std::memcmp(journalData.getData(), journalMagic, sizeof(journalMagic)) != 0) {
+        return Result::ok(); // Crashed before the journal was started, so the snapshot is everything
+    }
+    MemoryInputStream input(journalData, false);
+    input.setPosition(sizeof(journalMagic));
+    if (input.readInt() != journalVersion) {
+        DBG("Unsupported autosave journal version; recovered the snapshot only");
+        return Result::ok();
+    }
+
+    size_t replayed = 0;
+    while (input.getNumBytesRemaining() >= static_cast<int64>(recordFrameSize)) {
+        const auto bodySize = static_cast<uint32>(input.readInt());
+        const auto expectedChecksum = static_cast<uint32>(input.readInt());
+        if (bodySize == 0 || bodySize > input.getNumBytesRemaining()) {
+            break; // Torn write at the end of the journal
+        }
+        const auto *body = static_cast<const char *>(journalData.getData()) + input.getPosition();
+        if (checksum(body, bodySize) != expectedChecksum) {
+            break;
+        }
+        MemoryInputStream record(body, bodySize, false);
+        input.skipNextBytes(bodySize);
+
+        const auto type = static_cast<uint8>(record.readByte());
+        const auto index = static_cast<size_t>(record.readInt64());
+        if (type == CUE_INSERTED && index <= recoveredCCIs.size()) {
+            // Records are packed back to back, so the cue's show file needs copying to a block aligned for its records
+            const MemoryBlock cueData(body + record.getPosition(), static_cast<size_t>(record.getNumBytesRemaining()));
+            ShowFile cueFile;
+            if (cueFile.open(cueData.getData(), cueData.getSize()).failed()) {
+                break;
+            }
+            size_t droppedActions;
+            auto built = cueFile.buildCues(droppedActions);
+            if (built.size() != 1 || droppedActions > 0) {
+                break;
+            }
+            recoveredCCIs.insert(recoveredCCIs.begin() + static_cast<std::ptrdiff_t>(index), std::move(built.front()));
+        } else if (type == CUE_ERASED && index < recoveredCCIs.size()) {
+            recoveredCCIs.erase(recoveredCCIs.begin() + static_cast<std::ptrdiff_t>(index));
+        } else if (type == CUE_MOVED && index < recoveredCCIs.size()) {
+            const auto newIndex = static_cast<size_t>(record.readInt64());
+            if (newIndex >= recoveredCCIs.size()) {
+                break;
+            }
+            const auto first = recoveredCCIs.begin();
+            if (index < newIndex) {
+                std::rotate(first + index, first + index + 1, first + newIndex + 1);
+            } else {
+                std::rotate(first + newIndex, first + index, first + index + 1);
+            }
+        } else {
+            break; // A record that doesn't fit the show means the journal doesn't belong to this snapshot
+        }
+        replayed++;
+    }
+    if (input.getNumBytesRemaining() > 0) {
+        DBG("Autosave journal ends in a torn or corrupt record; recovered the " + String(replayed) + " records before it");
+    }
+    return Result::ok();
+}
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    AutosaveJournal.h
+    Created: 17 Oct 2026 6:03:52pm
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include "Helpers.h"
+#include "ShowFile.h"
+
+
+/* Persists every edit of the cue list as it happens, so a crash mid-show loses (at most) the last few milliseconds of
+ * edits. The autosave directory holds:
+ *   snapshot-<generation>.xm32show - the whole show (see ShowFile) as it was when the generation started
+ *   journal-<generation>.log - every edit made since, as checksummed records appended after a short header
+ * Recovery opens the newest snapshot and replays its journal, stopping at the first torn or corrupt record.
+ *
+ * Edits are encoded into records on the message thread (no I/O) and handed to a writer thread. Snapshots are handed
+ * over as a copy of the cues, and serialised by the writer thread. The writer waits a
+ * moment after being woken so a burst of edits is written, and synced to disk, together (group commit). Every
+ * compactAfterRecords records, and whenever the show is replaced, the show is snapshotted into a new generation, and
+ * the old generation's files are deleted once the new snapshot is safely on disk.
+ * If a write fails, autosave stops for the rest of the run and onFailure is called, rather than carrying on with a
+ * journal that can't be recovered from.
+ */
+class AutosaveJournal: public CueListMutationListener, private Thread {
+public:
+    static constexpr int groupCommitWindowMs = 20;
+    static constexpr size_t compactAfterRecords = 1000;
+
+    AutosaveJournal(const File &directory, CurrentCueInfoVector &cciVector, const ActiveShowOptions &activeShowOptions);
+
+    // Writes everything still pending before returning. The autosave is kept; see discard().
+    ~AutosaveJournal() override;
+
+    // Snapshots the current show and starts journalling its edits. Recover any previous autosave first (or set it
+    // aside if it can't be), as this replaces it.
+    void start();
+
+    // Stops journalling and deletes the autosave. For when the app closes cleanly and there's nothing to recover.
+    void discard();
+
+    // Starts a new generation from the current show. Only copies the cues here (their strings, templates and packets
+    // are shared, not copied); the writer thread serialises and writes them.
+    void compact();
+
+    // True if directory holds an autosave, i.e., the last run didn't close cleanly.
+    static bool hasAutosave(const File &directory);
+
+    // Rebuilds the show from the newest snapshot in directory and its journal.
+    static Result recover(const File &directory, std::vector<CurrentCueInfo> &recoveredCCIs, String &showName,
+                          String &showDescription);
+
+    // Moves every generation in directory into a new folder inside it, so start() doesn't replace an autosave that
+    // couldn't be recovered. Returns the folder, or File() if any file couldn't be moved.
+    static File setAside(const File &directory);
+
+    // Called once, with the reason, the first time autosave has to stop: on the message thread if start() can't
+    // create the directory, otherwise on the writer thread. Set it before start().
+    std::function<void(const String &reason)> onFailure;
+
+    void cueInserted(size_t index, const CurrentCueInfo &cci) override;
+    void cueErased(size_t index) override;
+    void cueMoved(size_t oldIndex, size_t newIndex) override;
+    void cuesReset() override;
+
+private:
+    // The show as it was when a generation started
+    struct Snapshot {
+        std::vector<CurrentCueInfo> cues;
+        String showName;
+        String showDescription;
+    };
+
+    // Work for the writer thread, in the order it was queued
+    struct PendingWrite {
+        enum Type { RECORDS, SNAPSHOT };
+
+        Type type;
+        uint64 generation;
+        MemoryBlock data; // Encoded records. Empty for SNAPSHOT.
+        Snapshot snapshot; // Empty for RECORDS
+    };
+
+    const File directory;
+    CurrentCueInfoVector &cciVector;
+    const ActiveShowOptions &activeShowOptions;
+
+    // Message thread only
+    bool started{false};
+    uint64 generation{0};
+    size_t recordsSinceSnapshot{0};
+
+    std::mutex pendingMutex;
+    std::vector<PendingWrite> pending; // Consecutive records are appended to the same RECORDS write
+
+    // Writer thread only
+    std::unique_ptr<FileOutputStream> journal;
+    uint64 journalGeneration{0};
+
+    std::atomic<bool> disabled{false}; // Set by fail(). Nothing is queued or written after.
+
+    void queueRecord(const MemoryBlock &record);
+    void queueSnapshot(uint64 snapshotGeneration, Snapshot snapshot);
+
+    void run() override;
+    void writePending();
+    bool writeSnapshot(uint64 snapshotGeneration, const Snapshot &snapshot);
+    void deleteGenerationsBefore(uint64 firstKept) const;
+    void fail(const String &reason);
+
+    File getSnapshotFile(uint64 fileGeneration) const { return getSnapshotFile(directory, fileGeneration); }
+    File getJournalFile(uint64 fileGeneration) const { return getJournalFile(directory, fileGeneration); }
+    static File getSnapshotFile(const File &directory, uint64 fileGeneration);
+    static File getJournalFile(const File &directory, uint64 fileGeneration);
+    // Returns false if directory holds no snapshot
+    static bool findNewestGeneration(const File &directory, uint64 &newest);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutosaveJournal)
+};
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    CueStateTracker.cpp
+    Created: 17 Oct 2026 9:37:12pm
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#include "CueStateTracker.h"
+
+
+const TrackedValue *TrackedState::find(uint32 addressID) const {
+    if (const auto changed = changes.find(addressID); changed != changes.end()) {
+        return &changed->second;
+    }
+    const auto chunk = addressID / chunkSize;
+    if (checkpoint == nullptr || chunk >= checkpoint->size() || (*checkpoint)[chunk] == nullptr) {
+        return nullptr;
+    }
+    const auto &tracked = (*(*checkpoint)[chunk])[addressID % chunkSize];
+    return tracked.isSet() ? &tracked : nullptr;
+}
+
+
+TrackedState::Checkpoint TrackedState::applyChanges(const Checkpoint &checkpoint, const Changes &changes) {
+    if (changes.empty()) {
+        return checkpoint;
+    }
+    auto chunks = checkpoint != nullptr
+                      ? std::make_shared<std::vector<std::shared_ptr<const Chunk>>>(*checkpoint)
+                      : std::make_shared<std::vector<std::shared_ptr<const Chunk>>>();
+    // Each changed chunk is copied once, however many of its addresses changed
+    std::unordered_map<size_t, std::shared_ptr<Chunk>> copiedChunks;
+    for (const auto &[addressID, tracked]: changes) {
+        const auto chunk = addressID / chunkSize;
+        if (chunk >= chunks->size()) {
+            chunks->resize(chunk + 1);
+        }
+        auto &copy = copiedChunks[chunk];
+        if (copy == nullptr) {
+            copy = (*chunks)[chunk] != nullptr ? std::make_shared<Chunk>(*(*chunks)[chunk]) : std::make_shared<Chunk>();
+            (*chunks)[chunk] = copy;
+        }
+        (*copy)[addressID % chunkSize] = tracked;
+    }
+    return chunks;
+}
+
+
+// ==============================================================================
+
+
+CueStateTracker::CueStateTracker(CurrentCueInfoVector &cciVector, size_t checkpointInterval):
+    cciVector(cciVector), checkpointInterval(std::max<size_t>(1, checkpointInterval)) {
+    cciVector.addMutationListener(this);
+}
+
+
+CueStateTracker::~CueStateTracker() {
+    cciVector.removeMutationListener(this);
+}
+
+
+TrackedState CueStateTracker::getStateBefore(size_t cueIndex) {
+    cueIndex = std::min(cueIndex, cciVector.getSize());
+    const auto checkpointIndex = cueIndex / checkpointInterval;
+
+    // Bring the checkpoints up to the one needed, each from the one before
+    while (checkpoints.size() <= checkpointIndex) {
+        const auto first = (checkpoints.size() - 1) * checkpointInterval;
+        TrackedState::Changes changes;
+        replay(first, first + checkpointInterval, changes);
+        checkpoints.push_back(TrackedState::applyChanges(checkpoints.back(), changes));
+    }
+
+    TrackedState state;
+    state.checkpoint = checkpoints[checkpointIndex];
+    replay(checkpointIndex * checkpointInterval, cueIndex, state.changes);
+    return state;
+}
+
+
+void CueStateTracker::invalidateFrom(size_t cueIndex) {
+    // checkpoints[i] depends on cues [0, i * checkpointInterval), so only those at or before cueIndex survive
+    checkpoints.resize(std::min(checkpoints.size(), cueIndex / checkpointInterval + 1));
+}
+
+
+void CueStateTracker::replay(size_t first, size_t last, TrackedState::Changes &changes) {
+    last = std::min(last, cciVector.getSize());
+    for (size_t index = first; index < last; index++) {
+        const auto &cci = cciVector.getCurrentCueInfoByIndex(index);
+        for (const auto &action: cci.actions) {
+            // A fade leaves its address on its end value
+            if (action.oat == OAT_COMMAND) {
+                changes[action.oscAddress.getID()] = {action.argument, cci.getHandle(), action.handle};
+            } else if (action.oat == OAT_FADE) {
+                changes[action.oscAddress.getID()] = {action.endValue, cci.getHandle(), action.handle};
+            }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    CueStateTracker.h
+    Created: 17 Oct 2026 9:37:12pm
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include "Helpers.h"
+
+
+// The last value sent to an address, and the action that sent it
+struct TrackedValue {
+    ValueStorer value; // A command's argument, or the end value of a fade
+    CueHandle cue; // Null when nothing has set the address
+    ActionHandle action;
+
+    [[nodiscard]] bool isSet() const { return !action.isNull(); }
+};
+
+
+/* The value of every address at some point in the show: a checkpoint shared with CueStateTracker, plus the changes
+ * made by the few cues since it. Copies share the checkpoint, so they're cheap.
+ */
+class TrackedState {
+public:
+    // nullptr if no cue before this point sets the address
+    [[nodiscard]] const TrackedValue *find(uint32 addressID) const;
+    [[nodiscard]] const TrackedValue *find(const InternedOSCAddress &address) const { return find(address.getID()); }
+
+    // Calls f(addressID, const TrackedValue&) for every address that's been set, in no particular order.
+    template<typename Function>
+    void forEach(Function f) const {
+        if (checkpoint != nullptr) {
+            for (size_t chunk = 0; chunk < checkpoint->size(); chunk++) {
+                if ((*checkpoint)[chunk] == nullptr) {
+                    continue;
+                }
+                for (size_t slot = 0; slot < chunkSize; slot++) {
+                    const auto addressID = static_cast<uint32>(chunk * chunkSize + slot);
+                    const auto &tracked = (*(*checkpoint)[chunk])[slot];
+                    if (tracked.isSet() && changes.count(addressID) == 0) {
+                        f(addressID, tracked);
+                    }
+                }
+            }
+        }
+        for (const auto &[addressID, tracked]: changes) {
+            f(addressID, tracked);
+        }
+    }
+
+private:
+    friend class CueStateTracker;
+
+    /* A checkpoint is a copy-on-write array indexed by InternedOSCAddress ID (which are dense), split into chunks.
+     * Each checkpoint only copies the chunks its cues changed and shares the rest with the checkpoint before it, so
+     * checkpoints cost memory in proportion to what changed, not to the number of addresses.
+     */
+    static constexpr size_t chunkSize = 64;
+    using Chunk = std::array<TrackedValue, chunkSize>;
+    using Checkpoint = std::shared_ptr<const std::vector<std::shared_ptr<const Chunk>>>; // nullptr when empty
+    using Changes = std::unordered_map<uint32, TrackedValue>;
+
+    Checkpoint checkpoint;
+    Changes changes; // Made since the checkpoint. Override it.
+
+    static Checkpoint applyChanges(const Checkpoint &checkpoint, const Changes &changes);
+};
+
+
+/* Answers "what will each address be set to at cue N": the last value any earlier cue's actions set it to. Used to put
+ * the console in the state a cue expects when jumping to it.
+ * Keeps a checkpoint of every address's value every checkpointInterval cues, so a query only replays the cues since
+ * the nearest checkpoint: O(checkpointInterval + changed addresses), however long the show.
+ * Checkpoints are built when first asked for. An edit only marks the checkpoints after it stale (it's told about edits
+ * as a CueListMutationListener), and they're rebuilt on the next query that needs them. Message thread only.
+ */
+class CueStateTracker: public CueListMutationListener {
+public:
+    static constexpr size_t defaultCheckpointInterval = 64;
+
+    explicit CueStateTracker(CurrentCueInfoVector &cciVector, size_t checkpointInterval = defaultCheckpointInterval);
+    ~CueStateTracker() override;
+
+    // Every address's value once cues [0, cueIndex) have run, i.e., just before cueIndex runs.
+    TrackedState getStateBefore(size_t cueIndex);
+
+    // Every address's value once cueIndex has run.
+    TrackedState getStateAfter(size_t cueIndex) { return getStateBefore(cueIndex + 1); }
+
+    void cueInserted(size_t index, const CurrentCueInfo &cci) override { invalidateFrom(index); }
+    void cueErased(size_t index) override { invalidateFrom(index); }
+    void cueMoved(size_t oldIndex, size_t newIndex) override { invalidateFrom(std::min(oldIndex, newIndex)); }
+    void cuesReset() override { invalidateFrom(0); }
+
+private:
+    CurrentCueInfoVector &cciVector;
+    const size_t checkpointInterval;
+
+    // checkpoints[i] is the state before cue i * checkpointInterval. checkpoints[0] (nothing set) is always there, and
+    // every checkpoint kept is up to date.
+    std::vector<TrackedState::Checkpoint> checkpoints{nullptr};
+
+    // Drops the checkpoints that depend on the cue at cueIndex
+    void invalidateFrom(size_t cueIndex);
+
+    // Adds the changes made by cues [first, last) to changes
+    void replay(size_t first, size_t last, TrackedState::Changes &changes);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CueStateTracker)
+};
@@ -11,7 +11,13 @@
 #include "Helpers.h"
 
 
-void ShowCommandListener::cueCommandOccurred(ShowCommand, std::string cciInternalID, size_t cciCurrentIndex) {}
+void ShowCommandListener::cueCommandOccurred(ShowCommand, CueHandle cciHandle, size_t cciCurrentIndex) {}
+
+void ShowCommandListener::cuesEdited(const CueEditSummary& edit) {
+    if (edit.cuesDeleted > 0) { commandOccurred(CUES_DELETED); }
+    if (edit.cuesAdded > 0) { commandOccurred(CUES_ADDED); }
+    if (edit.cuesMoved > 0) { commandOccurred(CUE_INDEXS_CHANGED); }
+}
 
 
 String formatValueUsingUnit(const Units unit, double value) {
@@ -89,7 +95,7 @@ OSCMessage CurrentCueInfo::constructMessage(bool ignoreAndReconstructCache) {
                     msg.addFloat32(valueStore.floatValue);
                     break;
                 case STRING:
-                    msg.addString(valueStore.stringValue);
+                    msg.addString(valueStore.stringValue.toStdString());
                     break;
                 default:
                     jassertfalse; // No other ParamTypes are valid for ValueStorer.
@@ -319,3 +325,205 @@ double inferPercentageFromMinMaxAndValue(const double minVal, const double maxVa
     jassertfalse; // Value is out of range from minVal to maxVal
     return 0.0;
 }
+
+
+int getNormalisedQuantisationSteps(const NonIter &param) {
+    switch (param._meta_PARAMTYPE) {
+        case LEVEL_1024:
+            return 1023; // See XM32::dbToDouble
+        case LEVEL_161:
+            return static_cast<int>(levelValues_161.size()) - 1;
+        case LOGF:
+            // The only log grid the X32 uses over the full audible range
+            if (param.floatMin == 20.f && param.floatMax == 20000.f) {
+                return static_cast<int>(logScaleFreq_201.size()) - 1;
+            }
+            return 0;
+        case INT: {
+            // Every integer is a step. Ranges wider than this are not real console parameters.
+            const auto range = static_cast<int64>(param.intMax) - param.intMin;
+            return (range > 0 && range <= 100000) ? static_cast<int>(range) : 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+
+ArgumentTemplateRef::ArgumentTemplateRef(const NonIter &nonIter) {
+    auto copy = std::make_shared<const NonIter>(nonIter);
+    target = copy.get();
+    owned = std::move(copy);
+}
+
+
+ArgumentTemplateRef::ArgumentTemplateRef(const EnumParam &enumParam): kind(KIND_ENUM) {
+    auto copy = std::make_shared<const EnumParam>(enumParam);
+    target = copy.get();
+    owned = std::move(copy);
+}
+
+
+ArgumentTemplateRef::ArgumentTemplateRef(const OptionParam &optionParam): kind(KIND_OPTION) {
+    auto copy = std::make_shared<const OptionParam>(optionParam);
+    target = copy.get();
+    owned = std::move(copy);
+}
+
+
+ArgumentTemplateRef::ArgumentTemplateRef(const OSCMessageArguments &arguments) {
+    if (auto *optVal = std::get_if<OptionParam>(&arguments)) {
+        *this = ArgumentTemplateRef(*optVal);
+    } else if (auto *enumParam = std::get_if<EnumParam>(&arguments)) {
+        *this = ArgumentTemplateRef(*enumParam);
+    } else if (auto *nonIter = std::get_if<NonIter>(&arguments)) {
+        *this = ArgumentTemplateRef(*nonIter);
+    }
+}
+
+
+ArgumentTemplateRef ArgumentTemplateRef::resolveAgainstTable(const std::string &templateID) const {
+    if (isFromTable() || templateID.empty()) {
+        return *this;
+    }
+    const auto it = ID_TO_TEMPLATE_MAP.find(templateID);
+    if (it == ID_TO_TEMPLATE_MAP.end()) {
+        return *this; // Not in the table (or the table hasn't been generated yet), so keep the copy
+    }
+    const XM32Template &tplt = it->second;
+    ArgumentTemplateRef fromTable;
+    // OptionParams are never in the table
+    if (const auto *nonIter = getNonIter(); nonIter != nullptr && tplt._META_UsesNonIter &&
+                                            nonIter->isSimilar(tplt.NONITER)) {
+        fromTable.target = &tplt.NONITER;
+        return fromTable;
+    }
+    if (const auto *enumParam = getEnumParam(); enumParam != nullptr && !tplt._META_UsesNonIter &&
+                                                enumParam->isSimilar(tplt.ENUMPARAM)) {
+        fromTable.kind = KIND_ENUM;
+        fromTable.target = &tplt.ENUMPARAM;
+        return fromTable;
+    }
+    return *this;
+}
+
+
+OSCMessage CueOSCAction::buildCommandMessage(const InternedOSCAddress &oscAddress,
+                                             const ArgumentTemplateRef &argumentTemplate, const ValueStorer &argument) {
+    OSCMessage msg{oscAddress.getPattern()};
+    if (argumentTemplate.getOptionParam()) {
+        // If it's an OptionParam, the value from the ValueStorer will be the string.
+        msg.addString(argument.stringValue.toStdString());
+    } else if (argumentTemplate.getEnumParam()) {
+        // As this is not a OPTIONS, we only need the index of the ENUM as the value.
+        msg.addInt32(argument.intValue);
+    } else if (auto *nonIter = argumentTemplate.getNonIter()) {
+        // Let's first determine if the value is int, float, string or bitset
+        // The NonIter will indicate the type (_meta_PARAMTYPE)
+        switch (nonIter->_meta_PARAMTYPE) {
+            case INT: {
+                // Don't try "lin-f" it. Let it be.
+                msg.addInt32(argument.intValue);
+                break;
+            }
+            case LINF:
+            case LOGF:
+            case LEVEL_161:
+            case LEVEL_1024: {
+                // Adjust to normalised range (0.f-1.f)
+                if (nonIter->normalisedInverted) {
+                    msg.addFloat32(1 - inferPercentageFromMinMaxAndValue(nonIter->floatMin, nonIter->floatMax, argument.floatValue, nonIter->_meta_PARAMTYPE));
+                } else {
+                    msg.addFloat32(inferPercentageFromMinMaxAndValue(nonIter->floatMin, nonIter->floatMax, argument.floatValue, nonIter->_meta_PARAMTYPE));
+                }
+                break;
+            }
+            case STRING: {
+                msg.addString(argument.stringValue.toStdString());
+                break;
+            }
+            case BITSET: {
+                msg.addInt32(std::stoi(argument.stringValue.toStdString(), nullptr, 2));
+                break;
+            }
+            default:
+                jassertfalse;
+                // Unsupported ParamType for NonIter Parameter Template. Is it a template ValueStorer (i.e., ParamType blank?)
+        }
+
+    } else {
+        jassertfalse; // Invalid OSCMessageArguments type in the action
+    }
+    return msg;
+}
+
+
+std::shared_ptr<const MemoryBlock> CueOSCAction::compileCommandPacket(const InternedOSCAddress &oscAddress,
+                                                                      const ArgumentTemplateRef &argumentTemplate,
+                                                                      const ValueStorer &argument) {
+    return std::make_shared<const MemoryBlock>(
+        serialiseOSCMessage(buildCommandMessage(oscAddress, argumentTemplate, argument), &oscAddress));
+}
+
+
+void CueOSCAction::compilePacket() {
+    compiledPacket = compileCommandPacket(oscAddress, argumentTemplate, argument);
+}
+
+
+// Writes an OSC-string: the UTF-8 bytes, null-terminated and zero-padded to a multiple of 4 bytes.
+static void writePaddedOSCString(MemoryOutputStream &out, const String &str) {
+    const auto numBytes = str.getNumBytesAsUTF8();
+    out.write(str.toRawUTF8(), numBytes);
+    out.writeRepeatedByte(0, 4 - (numBytes % 4));
+}
+
+
+const OSCAddressPool::Entry &OSCAddressPool::intern(const OSCAddressPattern &address) {
+    const auto addressString = address.toString();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (const auto found = entryByAddress.find(addressString); found != entryByAddress.end()) {
+        return *found->second;
+    }
+    MemoryOutputStream wireForm;
+    writePaddedOSCString(wireForm, addressString);
+    entries.push_back({static_cast<uint32>(entries.size()), address, wireForm.getMemoryBlock()});
+    entryByAddress.emplace(addressString, &entries.back());
+    return entries.back();
+}
+
+
+MemoryBlock serialiseOSCMessage(const OSCMessage &message, const InternedOSCAddress *internedAddress) {
+    MemoryOutputStream out;
+    if (internedAddress != nullptr) {
+        jassert(internedAddress->toString() == message.getAddressPattern().toString());
+        const auto &wireForm = internedAddress->getPaddedWireForm();
+        out.write(wireForm.getData(), wireForm.getSize());
+    } else {
+        writePaddedOSCString(out, message.getAddressPattern().toString());
+    }
+
+    String typeTags{","};
+    for (const auto &arg: message) {
+        typeTags += String::charToString(arg.getType());
+    }
+    writePaddedOSCString(out, typeTags);
+
+    for (const auto &arg: message) {
+        if (arg.isInt32()) {
+            out.writeIntBigEndian(arg.getInt32());
+        } else if (arg.isFloat32()) {
+            out.writeFloatBigEndian(arg.getFloat32());
+        } else if (arg.isString()) {
+            writePaddedOSCString(out, arg.getString());
+        } else if (arg.isBlob()) {
+            const auto &blob = arg.getBlob();
+            out.writeIntBigEndian(static_cast<int>(blob.getSize()));
+            out.write(blob.getData(), blob.getSize());
+            out.writeRepeatedByte(0, (4 - (blob.getSize() % 4)) % 4);
+        } else {
+            jassertfalse; // Unsupported OSC argument type
+        }
+    }
+    return out.getMemoryBlock();
+}
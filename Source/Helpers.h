@@ -10,7 +10,12 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
 #include "XM32Maps.h"
 #include "modules.h"
 #include "X32Templates.h"
@@ -44,6 +49,30 @@ inline constexpr std::unordered_map<ShowCommand, ShowCommand> INDIVIDUAL_CUE_TO_
 };
 */
 
+// Runtime identities of CueOSCActions and CurrentCueInfos. Cheap to hash and compare, unlike the UUIDs, which are only
+// kept for persistence.
+using ActionHandle = RuntimeHandle;
+using CueHandle = RuntimeHandle;
+
+
+// Describes everything a committed bulk edit of a CurrentCueInfoVector did, so listeners can react once instead of
+// once per cue. Indexes are post-edit; anything in [firstAffectedIndex, lastAffectedIndex] may hold a different CCI.
+struct CueEditSummary {
+    size_t cuesAdded = 0;
+    size_t cuesDeleted = 0;
+    size_t cuesMoved = 0;
+    size_t firstAffectedIndex = static_cast<size_t>(-1);
+    size_t lastAffectedIndex = 0;
+
+    [[nodiscard]] bool isEmpty() const { return cuesAdded == 0 && cuesDeleted == 0 && cuesMoved == 0; }
+
+    void includeRange(size_t first, size_t last) {
+        firstAffectedIndex = std::min(firstAffectedIndex, first);
+        lastAffectedIndex = std::max(lastAffectedIndex, last);
+    }
+};
+
+
 class ShowCommandListener {
 public:
     virtual ~ShowCommandListener() = default;
@@ -62,11 +91,32 @@ public:
      * command applies the current cue, but if a cue event happens to a specific cue that is not currently selected,
      * some components may still require it (e.g., CueList classes). This is for those components.
      */
-    virtual void cueCommandOccurred(ShowCommand, std::string cciInternalID, size_t cciCurrentIndex);
+    virtual void cueCommandOccurred(ShowCommand, CueHandle cciHandle, size_t cciCurrentIndex);
+
+
+    /* Called once when a bulk edit of the cue list is committed, instead of one CUES_ADDED/CUES_DELETED/
+     * CUE_INDEXS_CHANGED per cue. By default, replays each kind of change that happened through commandOccurred once.
+     */
+    virtual void cuesEdited(const CueEditSummary&);
 };
 
 
 inline UUIDGenerator uuidGen;
+inline RuntimeHandleAllocator actionHandles;
+inline RuntimeHandleAllocator cueHandles;
+
+
+// Releases a handle back to its allocator when destroyed. Objects identified by a handle share one of these between
+// all their copies, so the handle is freed with the last copy.
+struct HandleOwner {
+    HandleOwner(RuntimeHandleAllocator &allocator, RuntimeHandle handle): allocator(allocator), handle(handle) {}
+    ~HandleOwner() { allocator.release(handle); }
+    HandleOwner(const HandleOwner &) = delete;
+    HandleOwner &operator=(const HandleOwner &) = delete;
+
+    RuntimeHandleAllocator &allocator;
+    const RuntimeHandle handle;
+};
 
 
 namespace UICfg {
@@ -191,32 +241,182 @@ enum OSCActionType {
 
 
 
+/* Lets a queued or running action be cancelled without touching the action itself: the dispatcher stamps the action
+ * with its cue's epoch and the global epoch when it is queued, and the action counts as cancelled as soon as either
+ * epoch moves on. Stopping a cue (or everything) is then a single atomic increment.
+ */
+struct DispatchEpoch {
+    std::shared_ptr<const std::atomic<uint64>> cueEpoch; // nullptr when the action was not queued as part of a cue
+    const std::atomic<uint64> *globalEpoch{nullptr};
+    uint64 cueEpochAtDispatch{0};
+    uint64 globalEpochAtDispatch{0};
+
+    [[nodiscard]] bool isCancelled() const {
+        return (cueEpoch && cueEpoch->load(std::memory_order_acquire) != cueEpochAtDispatch) ||
+               (globalEpoch && globalEpoch->load(std::memory_order_acquire) != globalEpochAtDispatch);
+    }
+};
+
+
+/* Every distinct OSC address used by actions, stored once however many actions use it. Each address gets a small
+ * integer ID and keeps its OSC wire form (null-terminated and padded to 4 bytes), ready to be copied into packets.
+ * Addresses are never removed, so entries can be read without locking. Interning is thread safe.
+ */
+class OSCAddressPool {
+public:
+    struct Entry {
+        const uint32 id; // Dense, from 0
+        const OSCAddressPattern pattern;
+        const MemoryBlock paddedWireForm;
+    };
+
+    const Entry &intern(const OSCAddressPattern &address);
+
+    // The number of addresses interned so far. Every ID is below this.
+    [[nodiscard]] size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+private:
+    struct StringHash {
+        size_t operator()(const String &str) const noexcept { return static_cast<size_t>(str.hashCode64()); }
+    };
+
+    mutable std::mutex mutex;
+    std::deque<Entry> entries; // A deque, so entries never move once interned
+    std::unordered_map<String, const Entry *, StringHash> entryByAddress;
+};
+
+
+inline OSCAddressPool oscAddressPool;
+
+
+// An address interned in oscAddressPool. Two of these compare equal (in O(1)) exactly when their addresses are equal.
+class InternedOSCAddress {
+public:
+    InternedOSCAddress(const OSCAddressPattern &address): entry(&oscAddressPool.intern(address)) {}
+
+    [[nodiscard]] uint32 getID() const { return entry->id; }
+    [[nodiscard]] const OSCAddressPattern &getPattern() const { return entry->pattern; }
+    [[nodiscard]] String toString() const { return entry->pattern.toString(); }
+    // The address as it appears at the start of an OSC packet
+    [[nodiscard]] const MemoryBlock &getPaddedWireForm() const { return entry->paddedWireForm; }
+
+    operator const OSCAddressPattern &() const { return entry->pattern; }
+
+    bool operator==(const InternedOSCAddress &other) const { return entry == other.entry; }
+    bool operator!=(const InternedOSCAddress &other) const { return entry != other.entry; }
+
+private:
+    const OSCAddressPool::Entry *entry; // Never nullptr
+};
+
+
+/* Refers to an action's argument template instead of holding a copy of it (and its names and description). Templates
+ * from the XM32Template table (see ID_TO_TEMPLATE_MAP) live as long as the app, so those are pointed at directly. Any
+ * other template is copied once and shared by every copy of the ref.
+ */
+class ArgumentTemplateRef {
+public:
+    // Blank, i.e., nullNonIter
+    ArgumentTemplateRef() = default;
+
+    // Copies the template. Use resolveAgainstTable() to swap the copy for the template table's own.
+    ArgumentTemplateRef(const NonIter &nonIter);
+    ArgumentTemplateRef(const EnumParam &enumParam);
+    ArgumentTemplateRef(const OptionParam &optionParam);
+    ArgumentTemplateRef(const OSCMessageArguments &arguments);
+
+    // Returns a ref to the template table's entry for templateID if it matches this template. Otherwise, returns a
+    // copy of this ref. Slow (compares every field), so only call it when an action is created.
+    [[nodiscard]] ArgumentTemplateRef resolveAgainstTable(const std::string &templateID) const;
+
+    // These return nullptr when the template is of another type.
+    [[nodiscard]] const NonIter *getNonIter() const {
+        return kind == KIND_NONITER ? static_cast<const NonIter *>(target) : nullptr;
+    }
+    [[nodiscard]] const EnumParam *getEnumParam() const {
+        return kind == KIND_ENUM ? static_cast<const EnumParam *>(target) : nullptr;
+    }
+    [[nodiscard]] const OptionParam *getOptionParam() const {
+        return kind == KIND_OPTION ? static_cast<const OptionParam *>(target) : nullptr;
+    }
+
+    // True if the template is the template table's, rather than a copy.
+    [[nodiscard]] bool isFromTable() const { return owned == nullptr; }
+
+private:
+    enum Kind { KIND_NONITER, KIND_ENUM, KIND_OPTION };
+
+    Kind kind{KIND_NONITER};
+    const void *target{&nullNonIter}; // Never nullptr
+    std::shared_ptr<const void> owned; // Keeps a copied template alive. nullptr when target is in the template table.
+};
+
+
+// An OAT_FADE start or end value. Fades are only ever of ints or floats, so this is a ValueStorer without the string.
+struct FadeValue {
+    int intValue{};
+    float floatValue{};
+    ParamType _meta_PARAMTYPE{BLANK};
+
+    FadeValue() = default;
+
+    // ValueStorer's members share storage, so only the live one is copied; the other stays zero.
+    FadeValue(const ValueStorer &value): intValue(value._meta_PARAMTYPE == INT ? value.intValue : 0),
+                                         floatValue(value._meta_PARAMTYPE == _GENERIC_FLOAT ? value.floatValue : 0.f),
+                                         _meta_PARAMTYPE(value._meta_PARAMTYPE) {
+        jassert(value._meta_PARAMTYPE != STRING); // Strings can't be faded
+    }
+
+    operator ValueStorer() const {
+        switch (_meta_PARAMTYPE) {
+            case INT:
+                return ValueStorer(intValue);
+            case _GENERIC_FLOAT:
+                return ValueStorer(floatValue);
+            default:
+                return {};
+        }
+    }
+};
+
+
 struct CueOSCAction {
     explicit CueOSCAction(bool exitThread): oat(EXIT_THREAD), oscAddress("/") {
     }
 
     // For OAT_COMMAND, the arguments are used to fill in the OSC Message.
-    CueOSCAction(OSCAddressPattern oscAddress, OSCMessageArguments argumentTemplate, ValueStorer argument, std::string argumentTemplateID = ""): oat(OAT_COMMAND),
-        oatCommandOSCArgumentTemplate(argumentTemplate), argument(argument), oscAddress(oscAddress), ID(uuidGen.generate()),
+    // When argumentTemplateID names a template in the template table, the action refers to that template rather
+    // than keeping its own copy. persistentID is only given when loading a saved action; otherwise a new ID is made.
+    CueOSCAction(OSCAddressPattern oscAddress, const ArgumentTemplateRef &argumentTemplate, ValueStorer argument, std::string argumentTemplateID = "",
+                 const std::string &persistentID = ""): oat(OAT_COMMAND),
+        argumentTemplate(argumentTemplate.resolveAgainstTable(argumentTemplateID)), argument(argument), oscAddress(oscAddress),
+        ID(persistentID.empty() ? uuidGen.generate() : persistentID),
+    handle(actionHandles.allocate()), handleOwner(std::make_shared<const HandleOwner>(actionHandles, handle)),
     argumentTemplateID(argumentTemplateID) {
+        compilePacket();
     }
 
 
-    // For OAT_FADE, the fadeTime is used to determine the fade time in seconds.
-    CueOSCAction(OSCAddressPattern oscAddress, float fadeTime, NonIter oscArgumentTemplate, ValueStorer startValue,
-                 ValueStorer endValue, std::string argumentTemplateID = ""): oscAddress(oscAddress), oat(OAT_FADE), fadeTime(fadeTime),
-                                        oscArgumentTemplate(oscArgumentTemplate),
-                                        startValue(startValue), endValue(endValue), ID(uuidGen.generate()),
+    // For OAT_FADE, the fadeTime is used to determine the fade time in seconds. argumentTemplate must be a NonIter.
+    CueOSCAction(OSCAddressPattern oscAddress, float fadeTime, const ArgumentTemplateRef &argumentTemplate, FadeValue startValue,
+                 FadeValue endValue, std::string argumentTemplateID = "", const std::string &persistentID = ""): oscAddress(oscAddress), oat(OAT_FADE), fadeTime(fadeTime),
+                                        argumentTemplate(argumentTemplate.resolveAgainstTable(argumentTemplateID)),
+                                        startValue(startValue), endValue(endValue),
+                                        ID(persistentID.empty() ? uuidGen.generate() : persistentID),
+    handle(actionHandles.allocate()), handleOwner(std::make_shared<const HandleOwner>(actionHandles, handle)),
     argumentTemplateID(argumentTemplateID) {
+        jassert(argumentTemplate.getNonIter() != nullptr); // Only NonIters can be faded
         _checks();
     }
 
     // CueOSCAction(const CueOSCAction& other): oat(other.oat),
     //       oscAddress(other.oscAddress),
-    //       oatCommandOSCArgumentTemplate(other.oatCommandOSCArgumentTemplate),
+    //       argumentTemplate(other.argumentTemplate),
     //       argument(other.argument),
     //       fadeTime(other.fadeTime),
-    //       oscArgumentTemplate(other.oscArgumentTemplate),
     //       startValue(other.startValue),
     //       endValue(other.endValue),
     //       ID(uuidGen.generate()), // Generate a new unique ID for the copy
@@ -227,6 +427,7 @@ struct CueOSCAction {
 
     void _checks() const {
         if (oat == OAT_FADE) {
+            const auto &oscArgumentTemplate = getFadeTemplate();
             if (oscArgumentTemplate._meta_PARAMTYPE == INT &&
                 (startValue.intValue < oscArgumentTemplate.intMin ||
                  startValue.intValue > oscArgumentTemplate.intMax ||
@@ -245,25 +446,63 @@ struct CueOSCAction {
         }
     }
 
-    const std::string ID;
+    const std::string ID; // Persistent identity. Use handle at runtime.
+    // Runtime identity. Copies of the action (in the dispatcher's queue, the undo history, etc.) are the same action,
+    // so they share it. It is released when the last copy is destroyed. Null for EXIT_THREAD.
+    const ActionHandle handle;
 
     OSCActionType oat;
-    OSCAddressPattern oscAddress;
+    InternedOSCAddress oscAddress;
+
+    // For OAT_COMMAND, the template of the argument. For OAT_FADE, the NonIter used to find the algorithm and type
+    // for the parameter.
+    ArgumentTemplateRef argumentTemplate;
 
     // For OAT_COMMAND
-    // Let's sacrifice the extra memory for the sake of reliability and stability.
-    OSCMessageArguments oatCommandOSCArgumentTemplate = nullNonIter;
     ValueStorer argument; // The arguments to send with the OSC Message, only used for OAT_COMMAND
 
 
     // For OAT_FADE
     float fadeTime{0.f}; // The fade time in seconds, only used for OAT_FADE
-    NonIter oscArgumentTemplate = nullNonIter; // Used to find algorithm and type for parameter
-    ValueStorer startValue;
-    ValueStorer endValue;
+    FadeValue startValue;
+    FadeValue endValue;
 
     // Can be empty. Will be when unknown or template not used.
     std::string argumentTemplateID {}; // Correlates to XM32Template object used.
+
+    // For OAT_COMMAND, the message serialised to the bytes sent on the wire. Compiled once when the action is
+    // constructed - actions are never edited in place (editing constructs a new CueOSCAction), so it can't go stale.
+    // Shared so copying the action (e.g., into the dispatcher's queue) doesn't copy the packet. nullptr for OAT_FADE.
+    std::shared_ptr<const MemoryBlock> compiledPacket;
+
+    // Set by OSCCueDispatcherManager when the action is queued. See DispatchEpoch.
+    DispatchEpoch dispatchEpoch;
+
+    // The NonIter of an OAT_FADE action. nullNonIter if the action's template isn't a NonIter.
+    [[nodiscard]] const NonIter &getFadeTemplate() const {
+        const auto *nonIter = argumentTemplate.getNonIter();
+        return nonIter != nullptr ? *nonIter : nullNonIter;
+    }
+
+    // Builds the OSC Message for an OAT_COMMAND action from its argument template and argument.
+    [[nodiscard]] OSCMessage buildCommandMessage() const {
+        jassert(oat == OAT_COMMAND);
+        return buildCommandMessage(oscAddress, argumentTemplate, argument);
+    }
+
+    // Builds the OSC Message a command would send to oscAddress, without making a CueOSCAction (and its handle).
+    [[nodiscard]] static OSCMessage buildCommandMessage(const InternedOSCAddress &oscAddress,
+                                                        const ArgumentTemplateRef &argumentTemplate,
+                                                        const ValueStorer &argument);
+
+    // buildCommandMessage(), serialised to the bytes sent on the wire. See compiledPacket.
+    [[nodiscard]] static std::shared_ptr<const MemoryBlock> compileCommandPacket(
+        const InternedOSCAddress &oscAddress, const ArgumentTemplateRef &argumentTemplate, const ValueStorer &argument);
+
+private:
+    std::shared_ptr<const HandleOwner> handleOwner; // Shared by every copy of the action. Declared after handle.
+
+    void compilePacket();
 };
 
 
@@ -273,12 +512,14 @@ struct CurrentCueInfo {
     String name;
     String description;
     std::vector<CueOSCAction> actions;
-    bool currentlyPlaying {false};
 
 
+    // internalID is only given when loading a saved CCI; otherwise a new one is made.
     CurrentCueInfo(const String &id, const String &name, const String &description,
-                   const std::vector<CueOSCAction>& actions): id(id), name(name), description(description),
-                                                       actions(actions), INTERNAL_ID(uuidGen.generate()) {
+                   const std::vector<CueOSCAction>& actions, const std::string &internalID = ""): id(id), name(name), description(description),
+                                                       actions(actions), INTERNAL_ID(internalID.empty() ? uuidGen.generate() : internalID),
+                                                       handle(cueHandles.allocate()),
+                                                       handleOwner(std::make_shared<const HandleOwner>(cueHandles, handle)) {
     }
 
     // Used for blank CCI (i.e., invalid CCI)
@@ -289,51 +530,465 @@ struct CurrentCueInfo {
         return INTERNAL_ID.empty();
     }
 
+    // Persistent identity of the CCI. Use getHandle() at runtime.
     [[nodiscard]] std::string getInternalID() const {
         return INTERNAL_ID;
     }
 
+    // Runtime identity of the CCI, used to identify it in the CCI Vector. Null for a blank CCI.
+    [[nodiscard]] CueHandle getHandle() const {
+        return handle;
+    }
+
 private:
-    std::string INTERNAL_ID; // This is a unique ID for the CCI, used to identify it in the CCI Vector. Not used for UI, and not user-friendly
+    std::string INTERNAL_ID; // This is a unique ID for the CCI. Not used for UI, and not user-friendly
+    CueHandle handle;
+    std::shared_ptr<const HandleOwner> handleOwner; // Shared by every copy of the CCI. Declared after handle.
 };
 
 
-struct CurrentCueInfoVector {
-    std::vector<CurrentCueInfo> vector;
+/* Which actions, and so which cues, are running. Kept apart from the cue list so the dispatcher thread can report
+ * finished actions without locking, and without racing the message thread editing the list. Every operation is
+ * lock-free. An action is counted against its cue at most once, however many times it is started, stopped or reported
+ * finished, so late completions of stopped actions are harmless.
+ */
+class CueRunStates {
+public:
+    static constexpr size_t notRunning = static_cast<size_t>(-1);
+
+    // Marks every action in the CCI as running. Call before the actions are dispatched, so no completion can arrive
+    // before its action is counted.
+    void start(const CurrentCueInfo& cci) {
+        auto* cueState = cues.claim(cci.getHandle());
+        if (cueState == nullptr) {
+            jassertfalse; // More cue slots than the table holds
+            return;
+        }
+        if (cueState->handle.exchange(cci.getHandle().value, std::memory_order_acq_rel) != cci.getHandle().value) {
+            cueState->runningActions.store(0, std::memory_order_relaxed); // Slot was last used by another cue
+        }
+        for (const auto& action: cci.actions) {
+            auto* actionState = actions.claim(action.handle);
+            if (actionState == nullptr) {
+                jassertfalse; // More action slots than the table holds
+                continue;
+            }
+            if (actionState->handle.load(std::memory_order_acquire) == action.handle.value &&
+                actionState->running.load(std::memory_order_acquire)) {
+                continue; // Already running and counted
+            }
+            actionState->parent.store(cci.getHandle().value, std::memory_order_relaxed);
+            actionState->handle.store(action.handle.value, std::memory_order_release);
+            cueState->runningActions.fetch_add(1, std::memory_order_acq_rel);
+            actionState->running.store(true, std::memory_order_release);
+        }
+    }
+
+    /* Marks an action as finished. Safe to call from any thread. Returns the number of actions still running in its
+     * cue, and sets parent (if given) to the cue's handle. Returns notRunning if the action wasn't running (it was
+     * stopped already, its cue was deleted, or it was never started).
+     */
+    size_t finish(ActionHandle actionHandle, CueHandle* parent = nullptr) {
+        auto* actionState = actions.find(actionHandle);
+        if (actionState == nullptr || actionState->handle.load(std::memory_order_acquire) != actionHandle.value ||
+            !actionState->running.exchange(false, std::memory_order_acq_rel)) {
+            return notRunning;
+        }
+        const CueHandle cueHandle{actionState->parent.load(std::memory_order_relaxed)};
+        auto* cueState = cues.find(cueHandle);
+        if (cueState == nullptr || cueState->handle.load(std::memory_order_acquire) != cueHandle.value) {
+            return notRunning;
+        }
+        if (parent != nullptr) {
+            *parent = cueHandle;
+        }
+        return cueState->runningActions.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+
+    // Marks every action in the CCI as finished.
+    void stop(const CurrentCueInfo& cci) {
+        for (const auto& action: cci.actions) {
+            finish(action.handle);
+        }
+    }
+
+    [[nodiscard]] size_t getRunningActionCount(CueHandle cciHandle) const {
+        const auto* cueState = cues.find(cciHandle);
+        if (cueState == nullptr || cueState->handle.load(std::memory_order_acquire) != cciHandle.value) {
+            return 0;
+        }
+        return cueState->runningActions.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool isPlaying(CueHandle cciHandle) const {
+        return getRunningActionCount(cciHandle) > 0;
+    }
+
+private:
+    struct ActionState {
+        std::atomic<uint64> handle{0}; // The action currently using this slot
+        std::atomic<uint64> parent{0}; // Its CCI's handle
+        std::atomic<bool> running{false};
+    };
+
+    struct CueState {
+        std::atomic<uint64> handle{0}; // The CCI currently using this slot
+        std::atomic<size_t> runningActions{0};
+    };
+
+    RuntimeHandleTable<ActionState> actions;
+    RuntimeHandleTable<CueState> cues;
+};
+
+
+/* An inverted index over a cue list, for finding cues without walking every cue's actions. Each cue is filed under:
+ *   each word of its id, name and description (lower case, split at anything that isn't a letter or digit)
+ *   its actions' template IDs (argumentTemplateID)
+ *   every segment-wise prefix of its actions' addresses, with leading zeros dropped from numeric segments - so an
+ *   action on "/ch/01/mix/fader" files its cue under "/ch", "/ch/1", "/ch/1/mix" and "/ch/1/mix/fader"
+ * Every key lives in one sorted map, so words can be matched by prefix as they're typed. Kept up to date by
+ * CurrentCueInfoVector as cues are inserted and erased (CCIs are never edited in place). A lookup costs
+ * O(log keys + matches). Message thread only, like the vector.
+ */
+class CueSearchIndex {
+public:
+    using Matches = std::unordered_set<CueHandle>;
+
+    void add(const CurrentCueInfo& cci) {
+        for (const auto& key: getKeys(cci)) {
+            postings[key].insert(cci.getHandle());
+        }
+        version++;
+    }
+
+    // cci must be as it was when added
+    void remove(const CurrentCueInfo& cci) {
+        for (const auto& key: getKeys(cci)) {
+            const auto found = postings.find(key);
+            if (found == postings.end()) {
+                jassertfalse; // CCI was edited after it was added, or was never added
+                continue;
+            }
+            found->second.erase(cci.getHandle());
+            if (found->second.empty()) {
+                postings.erase(found);
+            }
+        }
+        version++;
+    }
+
+    void clear() {
+        postings.clear();
+        version++;
+    }
+
+    // Cues with an action on address, or on any address under it. E.g., "/ch/12" finds every cue touching channel 12,
+    // whether its addresses say "/ch/12" or "/ch/012".
+    [[nodiscard]] Matches findByAddress(const String& address) const {
+        return findKey(addressKind + normaliseAddress(address));
+    }
+
+    // Cues with an action using the template (case-insensitive)
+    [[nodiscard]] Matches findByTemplate(const String& argumentTemplateID) const {
+        return findKey(templateKind + argumentTemplateID.toLowerCase().toStdString());
+    }
+
+    // Cues with a word starting with wordPrefix in their id, name or description (case-insensitive)
+    [[nodiscard]] Matches findByWord(const String& wordPrefix) const {
+        Matches matches;
+        addPrefixMatches(wordKind + wordPrefix.toLowerCase().toStdString(), matches);
+        return matches;
+    }
+
+    /* Cues matching every whitespace-separated term in query, for filtering as the user types. A term starting with
+     * '/' is an address (see findByAddress()). Any other term matches the start of a word (split the same way as the
+     * cues' words, so "organ-2" needs both "organ" and "2") or of a template ID. An empty query matches no cues.
+     */
+    [[nodiscard]] Matches search(const String& query) const {
+        std::vector<Matches> termMatches;
+        for (const auto& term: StringArray::fromTokens(query, false)) {
+            if (term.startsWithChar('/')) {
+                const auto address = normaliseAddress(term);
+                if (!address.empty()) { // A lone "/" is still being typed, so doesn't narrow anything yet
+                    termMatches.push_back(findKey(addressKind + address));
+                }
+                continue;
+            }
+            for (const auto& word: splitWords(term)) {
+                Matches matches;
+                addPrefixMatches(wordKind + word, matches);
+                addPrefixMatches(templateKind + word, matches);
+                termMatches.push_back(std::move(matches));
+            }
+        }
+        if (termMatches.empty()) {
+            return {};
+        }
+
+        // Intersect, starting from the fewest matches so every pass is as short as possible
+        std::sort(termMatches.begin(), termMatches.end(),
+                  [](const Matches& a, const Matches& b) { return a.size() < b.size(); });
+        auto matches = std::move(termMatches.front());
+        for (size_t i = 1; i < termMatches.size() && !matches.empty(); i++) {
+            for (auto it = matches.begin(); it != matches.end();) {
+                it = termMatches[i].count(*it) ? std::next(it) : matches.erase(it);
+            }
+        }
+        return matches;
+    }
+
+    // Changes whenever the index does, so cached results can tell when they're stale
+    [[nodiscard]] uint64 getVersion() const { return version; }
+
+private:
+    // Each key starts with its kind, so each kind's keys are contiguous in the sorted map
+    static constexpr char wordKind = 'w';
+    static constexpr char templateKind = 't';
+    static constexpr char addressKind = 'a';
+
+    std::map<std::string, Matches> postings;
+    uint64 version{0};
+
+    [[nodiscard]] Matches findKey(const std::string& key) const {
+        const auto found = postings.find(key);
+        return found != postings.end() ? found->second : Matches();
+    }
+
+    void addPrefixMatches(const std::string& keyPrefix, Matches& matches) const {
+        for (auto it = postings.lower_bound(keyPrefix);
+             it != postings.end() && it->first.compare(0, keyPrefix.size(), keyPrefix) == 0; ++it) {
+            matches.insert(it->second.begin(), it->second.end());
+        }
+    }
+
+    static std::vector<std::string> splitWords(const String& text) {
+        std::vector<std::string> words;
+        String word;
+        const auto lowerCase = text.toLowerCase();
+        for (auto remaining = lowerCase.getCharPointer(); !remaining.isEmpty();) {
+            const auto character = remaining.getAndAdvance();
+            if (CharacterFunctions::isLetterOrDigit(character)) {
+                word += character;
+            } else if (word.isNotEmpty()) {
+                words.push_back(word.toStdString());
+                word.clear();
+            }
+        }
+        if (word.isNotEmpty()) {
+            words.push_back(word.toStdString());
+        }
+        return words;
+    }
+
+    // "/ch/01/mix/" -> "/ch/1/mix". Empty for an address without segments.
+    static std::string normaliseAddress(const String& address) {
+        std::string normalised;
+        for (auto segment: StringArray::fromTokens(address, "/", "")) {
+            if (segment.isEmpty()) {
+                continue;
+            }
+            if (segment.containsOnly("0123456789")) {
+                segment = segment.trimCharactersAtStart("0");
+                if (segment.isEmpty()) {
+                    segment = "0";
+                }
+            }
+            normalised += "/" + segment.toStdString();
+        }
+        return normalised;
+    }
+
+    // Every key cci is filed under, without duplicates
+    static std::vector<std::string> getKeys(const CurrentCueInfo& cci) {
+        std::vector<std::string> keys;
+        for (const auto* text: {&cci.id, &cci.name, &cci.description}) {
+            for (const auto& word: splitWords(*text)) {
+                keys.push_back(wordKind + word);
+            }
+        }
+        for (const auto& action: cci.actions) {
+            if (!action.argumentTemplateID.empty()) {
+                keys.push_back(templateKind + String(action.argumentTemplateID).toLowerCase().toStdString());
+            }
+            const auto address = normaliseAddress(action.oscAddress.toString());
+            for (size_t slash = address.find('/', 1); slash != std::string::npos; slash = address.find('/', slash + 1)) {
+                keys.push_back(addressKind + address.substr(0, slash));
+            }
+            if (!address.empty()) {
+                keys.push_back(addressKind + address);
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        return keys;
+    }
+};
+
 
+/* Told about every change to a CurrentCueInfoVector's cues as it is applied, one cue at a time and in order - including
+ * the changes made by bulk edits, undo and redo. Replaying the calls against a copy of the cues reproduces the vector.
+ * Calls are made on the thread editing the vector, mid-edit, so implementations must be quick and mustn't edit it.
+ */
+class CueListMutationListener {
+public:
+    virtual ~CueListMutationListener() = default;
+
+    virtual void cueInserted(size_t index, const CurrentCueInfo &cci) = 0;
+    virtual void cueErased(size_t index) = 0;
+    virtual void cueMoved(size_t oldIndex, size_t newIndex) = 0;
+    // Every cue was replaced. See CurrentCueInfoVector::reset().
+    virtual void cuesReset() = 0;
+};
+
+
+/* A columnar copy of every action in a cue list, for loops that scan a whole show. Each field is its own contiguous
+ * array, so a scan over (say) addresses or templates doesn't drag each action's strings and packets through the cache.
+ * Actions are stored in cue order, and each cue's actions occupy one contiguous range. Read-only once built; rebuild it
+ * rather than editing it (see CurrentCueInfoVector::getActionColumns()).
+ */
+class ActionColumns {
+public:
+    static constexpr uint32 noTemplate = 0; // templateIDs entry for actions without an argumentTemplateID
+
+    // A cue's actions are [first, first + count)
+    struct Range {
+        size_t first{0};
+        size_t count{0};
+    };
+
+    void clear() {
+        handles.clear();
+        types.clear();
+        addresses.clear();
+        templateIDs.clear();
+        startValues.clear();
+        endValues.clear();
+        fadeTimes.clear();
+        cueRanges.clear();
+    }
+
+    void reserve(size_t actionCount, size_t cueCount) {
+        handles.reserve(actionCount);
+        types.reserve(actionCount);
+        addresses.reserve(actionCount);
+        templateIDs.reserve(actionCount);
+        startValues.reserve(actionCount);
+        endValues.reserve(actionCount);
+        fadeTimes.reserve(actionCount);
+        cueRanges.reserve(cueCount);
+    }
+
+    // Appends the CCI's actions after those of the previously appended CCI.
+    void appendCue(const CurrentCueInfo& cci) {
+        cueRanges.push_back({handles.size(), cci.actions.size()});
+        for (const auto& action: cci.actions) {
+            handles.push_back(action.handle);
+            types.push_back(action.oat);
+            addresses.push_back(action.oscAddress);
+            templateIDs.push_back(internTemplateID(action.argumentTemplateID));
+            startValues.push_back(action.startValue);
+            endValues.push_back(action.endValue);
+            fadeTimes.push_back(action.fadeTime);
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return handles.size(); }
+
+    // Expects cueIndex < the number of cues appended
+    [[nodiscard]] Range getCueRange(size_t cueIndex) const { return cueRanges[cueIndex]; }
+
+    // Calls f(index) for every action sent to address. Compares interned addresses, so no strings are touched.
+    template<typename Function>
+    void forEachActionOn(const InternedOSCAddress& address, Function f) const {
+        for (size_t i = 0; i < addresses.size(); i++) {
+            if (addresses[i] == address) {
+                f(i);
+            }
+        }
+    }
+
+    // Template IDs run from 1 to getTemplateCount(); noTemplate is not counted.
+    [[nodiscard]] size_t getTemplateCount() const { return templateNames.size(); }
+
+    // Returns the argumentTemplateID interned as id by these columns, or an empty string for noTemplate.
+    [[nodiscard]] const std::string& getTemplateName(uint32 id) const {
+        static const std::string none;
+        return id == noTemplate || id > templateNames.size() ? none : templateNames[id - 1];
+    }
+
+    [[nodiscard]] const std::vector<ActionHandle>& getHandles() const { return handles; }
+    [[nodiscard]] const std::vector<OSCActionType>& getTypes() const { return types; }
+    [[nodiscard]] const std::vector<InternedOSCAddress>& getAddresses() const { return addresses; }
+    [[nodiscard]] const std::vector<uint32>& getTemplateIDs() const { return templateIDs; }
+    [[nodiscard]] const std::vector<FadeValue>& getStartValues() const { return startValues; }
+    [[nodiscard]] const std::vector<FadeValue>& getEndValues() const { return endValues; }
+    [[nodiscard]] const std::vector<float>& getFadeTimes() const { return fadeTimes; }
+
+private:
+    std::vector<ActionHandle> handles;
+    std::vector<OSCActionType> types;
+    std::vector<InternedOSCAddress> addresses;
+    std::vector<uint32> templateIDs; // See getTemplateName()
+    std::vector<FadeValue> startValues;
+    std::vector<FadeValue> endValues;
+    std::vector<float> fadeTimes;
+
+    std::vector<Range> cueRanges; // In cue order
+
+    // Template IDs are kept across rebuilds, so a given argumentTemplateID keeps its number
+    std::unordered_map<std::string, uint32> templateIDLookup;
+    std::vector<std::string> templateNames;
+
+    uint32 internTemplateID(const std::string& argumentTemplateID) {
+        if (argumentTemplateID.empty()) {
+            return noTemplate;
+        }
+        const auto found = templateIDLookup.find(argumentTemplateID);
+        if (found != templateIDLookup.end()) {
+            return found->second;
+        }
+        templateNames.push_back(argumentTemplateID);
+        const auto id = static_cast<uint32>(templateNames.size());
+        templateIDLookup.emplace(argumentTemplateID, id);
+        return id;
+    }
+};
+
+
+struct CurrentCueInfoVector {
     CurrentCueInfo _blankCCI; // A blank CCI to return when an index is out of range or when no CCIs are available
     // Pre-created to avoid recreating for every invalid CCI access
 
-    CurrentCueInfoVector(const CurrentCueInfoVector& other): vector(other.vector) {
-        size = vector.size();
-        reconstructCCIToIndexMap();
+    CurrentCueInfoVector(const CurrentCueInfoVector& other): order(other.order), cues(other.cues),
+                                                             internalIDToCue(other.internalIDToCue),
+                                                             searchIndex(other.searchIndex) {
         reconstructActionCCIMap();
     }
 
-    // Returns true if a CCI is in the vector. Uses the CCIIndexMap.
-    bool cciInVector(const std::string &cciInternalID) {
-        return cciIDtoIndexMap.find(cciInternalID) != cciIDtoIndexMap.end();
+    // Returns true if a CCI is in the vector.
+    bool cciInVector(CueHandle cciHandle) const {
+        return order.contains(cciHandle);
     }
 
-    // CurrentCueInfoVector(const std::vector<CurrentCueInfo>& cciVector): vector(cciVector), size(cciVector.size()) {}
-
 
-    explicit CurrentCueInfoVector(const std::vector<CurrentCueInfo>& cciVector): vector(cciVector), size(cciVector.size()) {
-        reconstructCCIToIndexMap();
+    explicit CurrentCueInfoVector(const std::vector<CurrentCueInfo>& cciVector) {
+        for (const auto& cci: cciVector) {
+            insertCCI(order.size(), cci);
+        }
         reconstructActionCCIMap();
     }
 
     // Returns a pointer to the current cue info.
     // When assigning to a variable, ensure the use of auto&, not auto.
     CurrentCueInfo& getCurrentCueInfoByIndex(size_t index) {
-        if (size == 0) {
+        if (order.size() == 0) {
             return _blankCCI;
         }
-        if (index >= size) {
+        if (index >= order.size()) {
             jassertfalse; // Index out of range
             return _blankCCI; // Return a blank CCI
         }
-        return vector[index];
+        return cues.at(order.at(index));
     }
 
 
@@ -344,51 +999,211 @@ struct CurrentCueInfoVector {
     }
 
 
-    // Warning: the returned iterator is invalidated if the vector is modified! Use at your own risk. If you wish to
-    // retrieve a CCI before deleting it, use getCurrentCueInfoByIndex() and then delete it.
-    std::vector<CurrentCueInfo>::iterator erase(std::vector<CurrentCueInfo>::const_iterator first, std::vector<CurrentCueInfo>::const_iterator last) {
-        auto iter = vector.erase(first, last);
-        uponCuesDeleted();
-        return iter;
+    // Erases the CCIs in [first, last). References to other CCIs stay valid. If you wish to retrieve a CCI before
+    // deleting it, use getCurrentCueInfoByIndex() and copy it first.
+    void erase(size_t first, size_t last) {
+        if (first > last || last > order.size()) {
+            jassertfalse; // Index out of range
+            return;
+        }
+        std::vector<CueHandle> toErase;
+        toErase.reserve(last - first);
+        for (size_t i = first; i < last; i++) {
+            toErase.push_back(order.at(i));
+        }
+        for (const auto& cciHandle: toErase) {
+            eraseCCI(cciHandle, first);
+        }
+        recordEdit(CUES_DELETED, last - first, first, order.size());
+        closeJournalStep();
     }
 
-    // Warning: the returned iterator is invalidated if the vector is modified! Use at your own risk. If you wish to
-    // retrieve a CCI before deleting it, use getCurrentCueInfoByIndex() and then delete it.
-    std::vector<CurrentCueInfo>::iterator erase(size_t index) {
-        auto iter = vector.erase(vector.begin() + index);
-        uponCuesDeleted();
-        return iter;
+    // Erases the CCI at index. References to other CCIs stay valid.
+    void erase(size_t index) {
+        erase(index, index + 1);
     }
 
-    // Warning: the returned iterator is invalidated if the vector is modified! Use at your own risk. If you wish to
-    // retrieve a CCI before deleting it, use getCurrentCueInfoByIndex() and then delete it.
-    std::vector<CurrentCueInfo>::iterator erase(const std::vector<CurrentCueInfo>::const_iterator first) {
-        auto iter = vector.erase(first);
-        uponCuesDeleted();
-        return iter;
+    // Walks the CCIs in order. Only erasing the CCI it points at invalidates it.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = CurrentCueInfo;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const CurrentCueInfo*;
+        using reference = const CurrentCueInfo&;
+
+        reference operator*() const { return cues->at(*position); }
+        pointer operator->() const { return &**this; }
+        const_iterator& operator++() { ++position; return *this; }
+        const_iterator operator++(int) { auto previous = *this; ++position; return previous; }
+        bool operator==(const const_iterator& other) const { return position == other.position; }
+        bool operator!=(const const_iterator& other) const { return position != other.position; }
+
+    private:
+        friend struct CurrentCueInfoVector;
+        const_iterator(OrderStatisticList<CueHandle>::const_iterator position,
+                       const std::unordered_map<CueHandle, CurrentCueInfo>* cues): position(position), cues(cues) {}
+
+        OrderStatisticList<CueHandle>::const_iterator position;
+        const std::unordered_map<CueHandle, CurrentCueInfo>* cues;
+    };
+
+    [[nodiscard]] const_iterator begin() const noexcept { return {order.begin(), &cues}; }
+    [[nodiscard]] const_iterator end() const noexcept { return {order.end(), &cues}; }
+
+    // Erases the CCI at position. Returns the iterator to the CCI after it.
+    const_iterator erase(const_iterator position) {
+        auto next = position;
+        erase(order.indexOf(*(next++).position));
+        return next;
+    }
+
+    // Erases the CCIs in [first, last). Returns last.
+    const_iterator erase(const_iterator first, const_iterator last) {
+        if (first == last) {
+            return last;
+        }
+        erase(order.indexOf(*first.position), last == end() ? order.size() : order.indexOf(*last.position));
+        return last;
     }
 
 
     void push_back(const CurrentCueInfo& cci) {
-        vector.push_back(cci);
-        uponCueAdd(cci);
+        insert(order.size(), cci);
     }
 
-    // Based off https://stackoverflow.com/a/57399634/16571234! Thanks for the algorithm!
+    // Inserts cci so that it ends up at index. index == getSize() appends.
+    void insert(size_t index, const CurrentCueInfo& cci) {
+        if (index > order.size()) {
+            jassertfalse; // Index out of range
+            return;
+        }
+        if (!insertCCI(index, cci)) {
+            return;
+        }
+        addToActionCCIMap(cci);
+        for (auto* mutationListener: mutationListeners) {
+            mutationListener->cueInserted(index, cci);
+        }
+        openStep.push_back({JournalEntry::INSERTED, index, index, cci.getHandle(), {}});
+        recordEdit(CUES_ADDED, 1, index, order.size());
+        closeJournalStep();
+    }
+
+    // Only the moved CCI's position in the order tree changes, so this is O(log n) regardless of distance moved.
     void move(size_t oldIndex, size_t newIndex) {
-        if (oldIndex > newIndex)
-            std::rotate(vector.rend() - oldIndex - 1, vector.rend() - oldIndex, vector.rend() - newIndex);
-        else
-            std::rotate(vector.begin() + oldIndex, vector.begin() + oldIndex + 1, vector.begin() + newIndex + 1);
-        updateCCIIndexMap(oldIndex, newIndex);
-        _notifyListeners(CUE_INDEXS_CHANGED);
+        if (oldIndex >= order.size() || newIndex >= order.size()) {
+            jassertfalse; // Index out of range
+            return;
+        }
+        order.move(oldIndex, newIndex);
+        actionColumnsStale = true;
+        for (auto* mutationListener: mutationListeners) {
+            mutationListener->cueMoved(oldIndex, newIndex);
+        }
+        openStep.push_back({JournalEntry::MOVED, oldIndex, newIndex, order.at(newIndex), {}});
+        recordEdit(CUE_INDEXS_CHANGED, 1, std::min(oldIndex, newIndex), std::max(oldIndex, newIndex) + 1);
+        closeJournalStep();
+    }
+
+
+    /* Undoes the last edit (or bulk edit, which undoes as one step). Returns false if there is nothing to undo.
+     * Undo and redo only replay the operations of the step, so they cost O(step size * log n), however big the show.
+     * Listeners get a single cuesEdited() for the whole step.
+     */
+    bool undo() {
+        return replayStep(undoSteps, UNDOING);
+    }
+
+    // Redoes the last undone step. Returns false if there is nothing to redo. Any new edit clears the redo history.
+    bool redo() {
+        return replayStep(redoSteps, REDOING);
     }
 
-    [[nodiscard]] std::vector<CurrentCueInfo>::const_iterator begin() const noexcept {
-        return vector.begin();
+    // Replaces every CCI, e.g., when a show is loaded. Clears the undo history. Listeners get FULL_SHOW_RESET.
+    // Pass a loaded show with std::move, so its cues are moved in rather than copied.
+    void reset(std::vector<CurrentCueInfo> newCCIs) {
+        if (bulkEditDepth > 0) {
+            jassertfalse; // Can't replace the show in the middle of a bulk edit
+            return;
+        }
+        undoSteps.clear();
+        redoSteps.clear();
+        for (const auto& [cciHandle, cci]: cues) {
+            runStates.stop(cci);
+        }
+        order.clear();
+        cues.clear();
+        actionColumnsStale = true;
+        internalIDToCue.clear();
+        searchIndex.clear();
+        for (auto& cci: newCCIs) {
+            insertCCI(order.size(), std::move(cci));
+        }
+        reconstructActionCCIMap();
+        for (auto* mutationListener: mutationListeners) {
+            mutationListener->cuesReset();
+        }
+        _notifyListeners(FULL_SHOW_RESET);
     }
 
-    [[nodiscard]] size_t getSize() const { return size; }
+    [[nodiscard]] bool canUndo() const { return !undoSteps.empty(); }
+    [[nodiscard]] bool canRedo() const { return !redoSteps.empty(); }
+
+    static constexpr size_t maxUndoSteps = 200;
+
+
+    /* Starts a bulk edit. Until the matching commitBulkEdit(), inserts, erases and moves only update the order tree
+     * and maps; listeners aren't told anything. Bulk edits can be nested, only the outermost commit notifies.
+     * Prefer ScopedBulkEdit so the commit can't be missed.
+     */
+    void beginBulkEdit() {
+        bulkEditDepth++;
+    }
+
+    // Ends a bulk edit. The outermost commit sends listeners a single cuesEdited() covering everything changed.
+    void commitBulkEdit() {
+        if (bulkEditDepth == 0) {
+            jassertfalse; // commitBulkEdit() without beginBulkEdit()
+            return;
+        }
+        if (--bulkEditDepth > 0) {
+            return;
+        }
+        closeJournalStep();
+        if (pendingEdit.isEmpty()) {
+            return;
+        }
+        auto edit = pendingEdit;
+        pendingEdit = {};
+        if (order.size() == 0) {
+            edit.firstAffectedIndex = edit.lastAffectedIndex = 0;
+        } else {
+            edit.lastAffectedIndex = std::min(edit.lastAffectedIndex, order.size() - 1);
+            edit.firstAffectedIndex = std::min(edit.firstAffectedIndex, edit.lastAffectedIndex);
+        }
+        for (auto& listener: listeners) {
+            if (listener != nullptr) {
+                listener->cuesEdited(edit);
+            } else {
+                jassertfalse; // Listener is null, this should never happen
+            }
+        }
+    }
+
+    // Begins a bulk edit on construction and commits it on destruction.
+    class ScopedBulkEdit {
+    public:
+        explicit ScopedBulkEdit(CurrentCueInfoVector& cciVector): cciVector(cciVector) { cciVector.beginBulkEdit(); }
+        ~ScopedBulkEdit() { cciVector.commitBulkEdit(); }
+
+        ScopedBulkEdit(const ScopedBulkEdit&) = delete;
+        ScopedBulkEdit& operator=(const ScopedBulkEdit&) = delete;
+    private:
+        CurrentCueInfoVector& cciVector;
+    };
+
+    [[nodiscard]] size_t getSize() const { return order.size(); }
 
 
     void addListener(ShowCommandListener* listener) {
@@ -403,251 +1218,310 @@ struct CurrentCueInfoVector {
         listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
     }
 
-    size_t getIndexByCCIInternalID(const std::string &cciInternalID) {
-        auto it = cciIDtoIndexMap.find(cciInternalID);
-        return it != cciIDtoIndexMap.end() ? it->second : sizeTLimit;
+    // Listeners are told about changes in the order they were added.
+    void addMutationListener(CueListMutationListener* listener) {
+        if (listener != nullptr) {
+            mutationListeners.push_back(listener);
+        } else {
+            jassertfalse; // Listener is null, this should never happen
+        }
     }
 
-    // Gets the parent CCI Internal ID of the CueOSCAction. Expects actionIDtoCCIInternalIDMap to be constructed and valid
-    // If not, returns empty string.
-    std::string getParentCCIInternalID(const CueOSCAction &action) {
-        auto it = actionIDtoCCIInternalIDMap.find(action.ID);
-        return it != actionIDtoCCIInternalIDMap.end() ? it->second : "";
+    void removeMutationListener(CueListMutationListener* listener) {
+        mutationListeners.erase(std::remove(mutationListeners.begin(), mutationListeners.end(), listener),
+                                mutationListeners.end());
     }
 
-    // Gets the parent CCI Internal ID of the CueOSCAction. Expects actionIDtoCCIInternalIDMap to be constructed and valid
-    // If not, returns empty string.
-    std::string getParentCCIInternalID(const std::string &actionID) {
-        auto it = actionIDtoCCIInternalIDMap.find(actionID);
-        return it != actionIDtoCCIInternalIDMap.end() ? it->second : "";
+    // Returns sizeTLimit if the CCI isn't in the vector
+    size_t getIndexByCCIHandle(CueHandle cciHandle) const {
+        return order.indexOf(cciHandle);
     }
 
-    // Sets an actionID as running. Automatically tries to get the cciInternalID from the actionIDtoCCIInternalIDMap
-    // If fail, nothing will occur.
-    void setAsRunning(const std::string &actionID, std::string cciInternalID = "") {
-        if (cciInternalID.empty()) {
-            // Figure it out ourselves
-            auto it = actionIDtoCCIInternalIDMap.find(actionID);
-            if (it == actionIDtoCCIInternalIDMap.end()) {
-                jassertfalse; // What do you mean the actionID doesn't have a parent CCI mapped?
-                return;
-            }
-            cciInternalID = it->second;
-        }
-        cciIDtoRunningActionIDsMap[cciInternalID].insert(actionID); // This will implicitly generate a set for
-        // cciIDtoRunningActionIDsMap[cciInternalID] if actionID is not yet in cciIDtoRunningActionIDsMap.
+    // Finds the CCI by its persistent ID (see CurrentCueInfo::getInternalID). Prefer getIndexByCCIHandle at runtime.
+    // Returns sizeTLimit if the CCI isn't in the vector.
+    size_t getIndexByCCIInternalID(const std::string &cciInternalID) const {
+        const auto found = internalIDToCue.find(cciInternalID);
+        return found != internalIDToCue.end() ? getIndexByCCIHandle(found->second) : sizeTLimit;
     }
 
-    // Loops through each action in the CCI and calls setAsRunning(std::string actionID, std::string cciInternalID = "")
-    // for each action.
-    void setAsRunning(const CurrentCueInfo& cci) {
-        auto cciInternalID = cci.getInternalID();
-        for (const auto& action: cci.actions) {
-            setAsRunning(action.ID, cciInternalID);
-        }
+    // Gets the parent CCI handle of the CueOSCAction. Expects actionToCueMap to be constructed and valid
+    // If not, returns a null handle.
+    CueHandle getParentCCIHandle(const CueOSCAction &action) {
+        return getParentCCIHandle(action.handle);
     }
 
-    // Removes an actionID from the list of running actions for a CCI.
-    // Does nothing if the actionID is not in the set of running actions for the CCI.
-    // Returns size_t limit (this->sizeTLimit) when failed. Otherwise, returns the number of actionIDs left
-    // in the set of running actionIDs for the cciInternalID (i.e., the number of running actions)
-    size_t removeFromRunning(const std::string &actionID, std::string cciInternalID = "") {
-        if (cciInternalID.empty()) {
-            // Figure it out ourselves
-            auto it = actionIDtoCCIInternalIDMap.find(actionID);
-            if (it == actionIDtoCCIInternalIDMap.end()) {
-                jassertfalse; // What do you mean the actionID doesn't have a parent CCI mapped?
-                return sizeTLimit;
-            }
-            cciInternalID = it->second;
-        }
-        // Now we can remove it from the map
-        auto cciIt = cciIDtoRunningActionIDsMap.find(cciInternalID);
-        if (cciIt != cciIDtoRunningActionIDsMap.end()) {
-            cciIt->second.erase(actionID); // Erase does not throw an exception, even if actionID mysteriously disappears
-            return cciIt->second.size();
-        }
+    // Gets the parent CCI handle of the CueOSCAction. Expects actionToCueMap to be constructed and valid
+    // If not, returns a null handle.
+    CueHandle getParentCCIHandle(ActionHandle actionHandle) {
+        auto it = actionToCueMap.find(actionHandle);
+        return it != actionToCueMap.end() ? it->second : CueHandle();
+    }
 
-        jassertfalse; // This should never happen! We should always have a CCI internal ID in the map.
-        return sizeTLimit;
+    // Marks every action in the CCI as running. Call before dispatching the CCI. Message thread only.
+    void setAsRunning(const CurrentCueInfo& cci) {
+        runStates.start(cci);
+    }
+
+    /* Marks an action as no longer running. Lock-free, and safe to call from any thread (e.g., the dispatcher's
+     * completion callbacks) while the message thread edits the vector. Returns sizeTLimit if the action wasn't
+     * running. Otherwise, returns the number of actions still running in its CCI, and sets parentCCIHandle (if given)
+     * to that CCI's handle.
+     */
+    size_t removeFromRunning(ActionHandle actionHandle, CueHandle* parentCCIHandle = nullptr) {
+        static_assert(CueRunStates::notRunning == sizeTLimit, "removeFromRunning reports notRunning as sizeTLimit");
+        return runStates.finish(actionHandle, parentCCIHandle);
     }
 
-    // Loops through all actions in the CCI and calls removeRunningActionID for each.
+    // Marks every action in the CCI as no longer running.
     void removeFromRunning(const CurrentCueInfo& cci) {
-        auto cciInternalID = cci.getInternalID();
-        for (const auto& action: cci.actions) {
-            removeFromRunning(action.ID, cciInternalID);
+        runStates.stop(cci);
+    }
+
+    // True while any of the CCI's actions are running. Safe to call from any thread.
+    [[nodiscard]] bool isPlaying(CueHandle cciHandle) const {
+        return runStates.isPlaying(cciHandle);
+    }
+
+    // Finds cues by address, template or words. Always up to date with the vector.
+    [[nodiscard]] const CueSearchIndex& getSearchIndex() const { return searchIndex; }
+
+    // Columnar copy of every action, in cue order. Only built when asked for, and rebuilt on the next call after the
+    // vector is edited, so use it for whole-show scans rather than between single edits. Message thread only.
+    const ActionColumns& getActionColumns() {
+        if (actionColumnsStale) {
+            size_t actionCount = 0;
+            for (const auto& [cciHandle, cci]: cues) {
+                actionCount += cci.actions.size();
+            }
+            actionColumns.clear();
+            actionColumns.reserve(actionCount, order.size());
+            for (const auto& cciHandle: order) {
+                actionColumns.appendCue(cues.at(cciHandle));
+            }
+            actionColumnsStale = false;
         }
+        return actionColumns;
     }
 
-    static constexpr size_t sizeTLimit = static_cast<size_t>(-1); // We use this to indicate an invalid index. But... if by some miracle the vector reaches this size, we must not use it.
+    static constexpr size_t sizeTLimit = OrderStatisticList<CueHandle>::npos; // We use this to indicate an invalid index. But... if by some miracle the vector reaches this size, we must not use it.
 private:
-    // A.k.a. CCIIndexMap
-    std::unordered_map<std::string, size_t> cciIDtoIndexMap; // Maps CCI internal ID to index in the vector
+    // Cue order is kept in an implicit treap so inserts, moves and index lookups are O(log n). The CCIs themselves
+    // live in a node-based map keyed by handle, so a CCI& stays valid while other cues are added, moved or erased.
+    OrderStatisticList<CueHandle> order;
+    std::unordered_map<CueHandle, CurrentCueInfo> cues;
+    std::unordered_map<std::string, CueHandle> internalIDToCue; // Kept in step with cues by insertCCI and eraseCCI
 
     // A.k.a., ActionCCIMap
     // A few notes about this:
-    // 1. An actionID's parent CCI should never change; hence its CCI Internal ID should never change
-    std::unordered_map<std::string, std::string> actionIDtoCCIInternalIDMap; // Maps actionIDs of each action in cci.actions to its parent's INTERNAL_ID (cci.INTERNAL_ID)
+    // 1. An action's parent CCI should never change; hence its CCI handle should never change
+    std::unordered_map<ActionHandle, CueHandle> actionToCueMap; // Maps the handle of each action in cci.actions to its parent's handle (cci.getHandle())
 
-    // A.k.a. RunningActionsMap
-    std::unordered_map<std::string, std::set<std::string>> cciIDtoRunningActionIDsMap; // Maps the CCI Internal IDs to the action IDs of the CCI which are still running
+    // Not copied with the vector: a copy starts with nothing running
+    CueRunStates runStates;
 
+    CueSearchIndex searchIndex;
 
-    size_t size;
-    std::vector<ShowCommandListener*> listeners;
+    // Not copied with the vector: a copy builds its own when asked
+    ActionColumns actionColumns;
+    bool actionColumnsStale = true;
 
-    void uponCueAdd(const CurrentCueInfo& cciAdded) {
-        size++;
-        if (size == sizeTLimit) {
-            jassertfalse; // ...how did you get so many elements inside the vector? The size_t limit is used in this struct to represent an invalid index, so this may break the "static_cast<size_t>(-1)"th element.
+    /* The undo journal is an operation log: each step lists the inserts, erases and moves of one edit (or bulk edit),
+     * in the order they were applied, so it costs memory proportional to the edit rather than the show. Only erases
+     * keep a copy of their CCI. Undoing a step applies the inverse of each entry in reverse, which journals those
+     * inverses as the matching redo step (and vice versa).
+     * Erased CCIs keep their handles while the journal holds them, so undoing an erase brings back the same CCI.
+     * Their handles are released with the last copy, once no step refers to them any more.
+     */
+    struct JournalEntry {
+        enum Type { INSERTED, ERASED, MOVED };
+        Type type;
+        size_t index; // Where the CCI was inserted or erased, or where it was moved from
+        size_t newIndex; // Where a moved CCI was moved to
+        CueHandle cciHandle;
+        std::optional<CurrentCueInfo> erasedCCI; // Only for ERASED
+    };
+    using JournalStep = std::vector<JournalEntry>;
+    enum JournalMode { RECORDING, UNDOING, REDOING };
+
+    std::deque<JournalStep> undoSteps;
+    std::deque<JournalStep> redoSteps;
+    JournalStep openStep; // Entries of the edit in progress
+    JournalMode journalMode = RECORDING;
+
+    // Files the open step once the outermost edit is done
+    void closeJournalStep() {
+        if (bulkEditDepth > 0 || openStep.empty()) {
+            return;
         }
-        addCCIToIndexMap(cciAdded.getInternalID());
-        addToActionCCIMap(cciAdded);
-        _notifyListeners(CUES_ADDED);
-    }
-
-
-    void uponCuesDeleted() {
-        size = vector.size();
-        reconstructCCIToIndexMap();
-        reconstructActionCCIMap();
-        _notifyListeners(CUES_DELETED);
+        if (journalMode == UNDOING) {
+            redoSteps.push_back(std::move(openStep));
+        } else {
+            if (journalMode == RECORDING) {
+                redoSteps.clear();
+            }
+            undoSteps.push_back(std::move(openStep));
+            if (undoSteps.size() > maxUndoSteps) {
+                undoSteps.pop_front();
+            }
+        }
+        openStep.clear();
     }
 
-
-    void _notifyListeners(const ShowCommand command) const {
-        for (auto& listener: listeners) {
-            if (listener != nullptr) {
-                listener->commandOccurred(command);
-            } else {
-                jassertfalse; // Listener is null, this should never happen
+    bool replayStep(std::deque<JournalStep>& steps, const JournalMode mode) {
+        if (steps.empty()) {
+            return false;
+        }
+        if (bulkEditDepth > 0) {
+            jassertfalse; // Can't undo or redo in the middle of a bulk edit
+            return false;
+        }
+        auto step = std::move(steps.back());
+        steps.pop_back();
+
+        journalMode = mode;
+        beginBulkEdit();
+        for (auto entry = step.rbegin(); entry != step.rend(); ++entry) {
+            switch (entry->type) {
+                case JournalEntry::INSERTED:
+                    jassert(entry->index < order.size() && order.at(entry->index) == entry->cciHandle); // Journal is out of step
+                    erase(entry->index);
+                    break;
+                case JournalEntry::ERASED:
+                    insert(entry->index, *entry->erasedCCI);
+                    break;
+                case JournalEntry::MOVED:
+                    move(entry->newIndex, entry->index);
+                    break;
             }
         }
+        commitBulkEdit();
+        journalMode = RECORDING;
+
+        return true; // The step goes with its erased CCIs, and the handles of any that weren't brought back
     }
 
 
-    // Completely reconstructs cciIDToIndexMap
-    void reconstructCCIToIndexMap() {
-        std::unordered_map<std::string, size_t> tempMap;
-        for (size_t i = 0; i < size; i++) {
-            tempMap[vector[i].getInternalID()] = i;
-        }
-        cciIDtoIndexMap = tempMap;
-    }
+    std::vector<ShowCommandListener*> listeners;
+    std::vector<CueListMutationListener*> mutationListeners;
 
+    size_t bulkEditDepth = 0;
+    CueEditSummary pendingEdit; // What the current bulk edit has changed so far
 
-    size_t manuallyFindIndexOfCCIByInternalID(const std::string& cciInternalID) const {
-        // This is a manual search, not using the map
-        for (size_t i = 0; i < size; i++) {
-            if (vector[i].getInternalID() == cciInternalID) {
-                return i;
-            }
+    /* Notifies listeners of a single edit, or folds it into pendingEdit during a bulk edit. [firstIndex, endIndex) is
+     * the post-edit range whose CCIs may have changed. Inserts and erases shift every later cue, so callers pass the
+     * vector's size as endIndex for them.
+     */
+    void recordEdit(const ShowCommand command, const size_t count, const size_t firstIndex, const size_t endIndex) {
+        if (bulkEditDepth == 0) {
+            _notifyListeners(command);
+            return;
         }
-        return sizeTLimit; // Not found
+        switch (command) {
+            case CUES_ADDED:
+                pendingEdit.cuesAdded += count;
+                break;
+            case CUES_DELETED:
+                pendingEdit.cuesDeleted += count;
+                break;
+            case CUE_INDEXS_CHANGED:
+                pendingEdit.cuesMoved += count;
+                break;
+            default:
+                jassertfalse; // Not a cue list edit
+                return;
+        }
+        pendingEdit.includeRange(firstIndex, endIndex == 0 ? 0 : endIndex - 1);
     }
 
-    /* Updates the cciIDtoIndexMap with an internal ID was not previously in the map
-     * The function will find the index of the new CCI by its ID. The index the CCI was added at does not need to be specified.
-     */
-    void addCCIToIndexMap(const std::string &cciInternalID) {
-        // Identify the index of the CCI
-        const size_t index = manuallyFindIndexOfCCIByInternalID(cciInternalID);
-        if (index == sizeTLimit) {
-            jassertfalse; // This should never happen! We should always have a CCI internal ID in the vector.
-            cciIDtoIndexMap[cciInternalID] = sizeTLimit;
-        }
-        cciIDtoIndexMap[cciInternalID] = index;
-        // If there's any elements after this index, we also need to update them
-        if (size - 1 == index) {
-            return; // Added at the end of the vector
-        }
-        // For every index in the cciIDToIndexMap after the newly added CCI's index, we need to increment it by one
-        // This is because we're basically pushing back the vector by one.
-        for (auto&[cciID, previousIndex]: cciIDtoIndexMap) {
-            if (previousIndex > index) {
-                previousIndex++;
-            }
+    // Inserts cci at index in the order tree and stores it. Returns false if the CCI's handle is already in the vector.
+    bool insertCCI(size_t index, CurrentCueInfo cci) {
+        const auto cciHandle = cci.getHandle();
+        if (!order.insert(index, cciHandle)) {
+            jassertfalse; // A CCI with this handle is already in the vector
+            return false;
         }
-
-
+        searchIndex.add(cci);
+        internalIDToCue[cci.getInternalID()] = cciHandle;
+        cues.emplace(cciHandle, std::move(cci));
+        actionColumnsStale = true;
+        return true;
     }
 
-    /* Updates the cciIDtoIndexMap based on the oldIndex and newIndex. Figured out after some maths.
-     * Useful for single move operations. Much faster than reconstructing the entire map
-     * Best for when CurrentCueInfoVector::move has been called and the CCI index map needs to updated accordingly.
-     * Only functions when ONE element in the vector has been moved.
-     */
-    void updateCCIIndexMap(size_t oldIndex, size_t newIndex) {
-        if (oldIndex == newIndex) { return; }
-        // When moving, the affected range of indexes will be between oldIndex and newIndex, inclusive.
-        size_t firstIndexChanged = std::min(oldIndex, newIndex);
-        size_t lastIndexChanged = std::max(oldIndex, newIndex);
-        bool increment = oldIndex > newIndex; // If the oldIndex is larger, then ++, otherwise --
-        if (oldIndex >= size || newIndex >= size) {
-            jassertfalse; // Index out of range
+    // Removes a CCI and everything mapped to it, and moves it into the open journal step as erased from index
+    void eraseCCI(CueHandle cciHandle, size_t index) {
+        auto found = cues.find(cciHandle);
+        if (found == cues.end()) {
+            jassertfalse; // Handle is in the order tree but not in the CCI map
+            order.erase(cciHandle);
             return;
         }
+        const auto& cci = found->second;
+        removeFromActionCCIMap(cci);
+        searchIndex.remove(cci);
+        internalIDToCue.erase(cci.getInternalID());
+        runStates.stop(cci);
+        openStep.push_back({JournalEntry::ERASED, index, index, cciHandle, std::move(found->second)});
+        cues.erase(found);
+        order.erase(cciHandle);
+        actionColumnsStale = true;
+        for (auto* mutationListener: mutationListeners) {
+            mutationListener->cueErased(index);
+        }
+    }
 
 
-        // Remove the old index from the map
-        // No `const auto&` it as we need to modify the map's elements
-        for (auto&[cciID, previousIndex] : cciIDtoIndexMap) {
-            // If the index matches the old index, changed it to the new index.
-            if (previousIndex == oldIndex) {
-                previousIndex = newIndex;
-                continue;
+    void _notifyListeners(const ShowCommand command) const {
+        for (auto& listener: listeners) {
+            if (listener != nullptr) {
+                listener->commandOccurred(command);
+            } else {
+                jassertfalse; // Listener is null, this should never happen
             }
-            if (previousIndex < firstIndexChanged || previousIndex > lastIndexChanged) { continue; }
-
-            if (increment)
-                previousIndex++;
-            else
-                previousIndex--;
         }
     }
 
-    // Reconstruct the actionID: CCI Internal ID map
+
+    // Reconstruct the action handle: CCI handle map
     void reconstructActionCCIMap() {
-        std::unordered_map<std::string, std::string> tempMap;
-        for (auto& cci: vector) {
+        std::unordered_map<ActionHandle, CueHandle> tempMap;
+        for (auto& [cciHandle, cci]: cues) {
             for (auto& action: cci.actions) {
-                tempMap[action.ID] = cci.getInternalID();
+                tempMap[action.handle] = cciHandle;
             }
         }
-        actionIDtoCCIInternalIDMap = tempMap;
+        actionToCueMap = tempMap;
     }
 
-    // Add an actionID to the action-CCI map by using a CCI
+    // Add an action to the action-CCI map by using a CCI
     void addToActionCCIMap(const CurrentCueInfo& cci) {
-        std::string cciInternalID = cci.getInternalID();
+        CueHandle cciHandle = cci.getHandle();
         for (const auto& action: cci.actions) {
-            actionIDtoCCIInternalIDMap[action.ID] = cciInternalID;
+            actionToCueMap[action.handle] = cciHandle;
         }
     }
 
-    // Add an actionID to the action-CCI map by using a CueOSCAction and its parent CCI
+    // Add an action to the action-CCI map by using a CueOSCAction and its parent CCI
     void addToActionCCIMap(const CueOSCAction& action, const CurrentCueInfo& parentCCI) {
-        actionIDtoCCIInternalIDMap[action.ID] = parentCCI.getInternalID();
+        actionToCueMap[action.handle] = parentCCI.getHandle();
     }
 
-    // Add an actionID to the action-CCI map by using a CueOSCAction and its parent CCI ID
-    void addToActionCCIMap(const CueOSCAction& action, const std::string &cciID) {
-        actionIDtoCCIInternalIDMap[action.ID] = cciID;
+    // Add an action to the action-CCI map by using a CueOSCAction and its parent CCI handle
+    void addToActionCCIMap(const CueOSCAction& action, CueHandle cciHandle) {
+        actionToCueMap[action.handle] = cciHandle;
     }
 
     // Add an actionID to the action-CCI map by using a CueOSCAction. Automatically tries to detect action's parent CCI
     // but expects the CCI containing the CueOSCAction to already be added to this CCIVector. Slower than using the
     // other overloads for this function.
     // WARNING: Will jassertfalse and return false if the action is not already in one of the CCIs in the CCIVector.
-    // However, this function will NOT add action.ID to the map. It is only guaranteed that action.ID is added to the
-    // map when true is returned
+    // However, this function will NOT add action.handle to the map. It is only guaranteed that action.handle is added
+    // to the map when true is returned
     bool addToActionCCIMap(const CueOSCAction& action) {
         // Find the parent CCI
-        for (const auto& cci: vector) {
-            for (const auto& possibleAction: cci.actions ) {
-                if (possibleAction.ID == action.ID) {
-                    actionIDtoCCIInternalIDMap[action.ID] = cci.getInternalID();
+        for (const auto& [cciHandle, cci]: cues) {
+            for (const auto& possibleAction: cci.actions) {
+                if (possibleAction.handle == action.handle) {
+                    actionToCueMap[action.handle] = cciHandle;
                     return true;
                 }
             }
@@ -659,13 +1533,13 @@ private:
 
     // Remove items from the action-CCI map by using a CueOSCAction
     void removeFromActionCCIMap(const CueOSCAction& action) {
-        actionIDtoCCIInternalIDMap.erase(action.ID);
+        actionToCueMap.erase(action.handle);
     }
 
     // Remove items from the action-CCI map by using a CCI
     void removeFromActionCCIMap(const CurrentCueInfo& cci) {
         for (const auto& action : cci.actions) {
-            actionIDtoCCIInternalIDMap.erase(action.ID);
+            actionToCueMap.erase(action.handle);
         }
     }
 };
@@ -677,7 +1551,7 @@ struct ActiveShowOptions {
     String showName; // Should be max-len of 24. Not Strict.
     String showDescription;
     String currentCueID;
-    std::string currentCueInternalID;
+    CueHandle currentCueHandle;
     size_t currentCueIndex; // Zero-indexed (0 --> n)
     bool currentCuePlaying;
     size_t numberOfCueItems; // NOT Zero-indexed
@@ -692,7 +1566,7 @@ struct ActiveShowOptions {
             currentCuePlaying = false;
             numberOfCueItems = 0;
             currentCueID = "";
-            currentCueInternalID = "";
+            currentCueHandle = {};
             return;
         }
         if (useIndex >= cciVSize) {
@@ -700,10 +1574,10 @@ struct ActiveShowOptions {
         }
         currentCueIndex = useIndex;
         auto& cci = cciVector.getCurrentCueInfoByIndex(useIndex);
-        currentCuePlaying = cci.currentlyPlaying;
+        currentCuePlaying = cciVector.isPlaying(cci.getHandle());
         currentCueID = cci.id;
         numberOfCueItems = cciVSize;
-        currentCueInternalID = cci.getInternalID();
+        currentCueHandle = cci.getHandle();
     }
 };
 
@@ -773,6 +1647,19 @@ double inferPercentageFromMinMaxAndValue(
     double minVal, double maxVal, double value, ParamType algorithm = ParamType::LINF);
 
 
+/* Returns the number of steps the console quantises a NonIter's normalised (0-1) value into, i.e., the value the
+ * console actually applies is round(normalised * steps) / steps. Returns 0 when the grid is unknown (or too fine to be
+ * worth tracking), in which case the value should be treated as continuous.
+ */
+int getNormalisedQuantisationSteps(const NonIter &param);
+
+
+/* Serialises an OSC Message to the bytes OSCSender would put on the wire (OSC 1.0: padded address, type tag string,
+ * then big-endian arguments). Supports int32, float32, string and blob arguments. Pass the message's interned address
+ * to copy its wire form rather than padding the address again. */
+MemoryBlock serialiseOSCMessage(const OSCMessage &message, const InternedOSCAddress *internedAddress = nullptr);
+
+
 // Generates a NormalisableRange for a logarithmic slider. From https://forum.juce.com/t/logarithmic-slider-for-frequencies-iir-hpf/37569/10
 static inline NormalisableRange<double> getNormalisableRangeExp(double min, double max) {
     jassert(min > 0.0);
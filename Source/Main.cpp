@@ -10,6 +10,8 @@
 
 #include "Helpers.h"
 #include "MainComponent.h"
+#include "ShowValidator.h"
+#include <thread>
 
 //==============================================================================
 class XM32CEApplication  : public JUCEApplication
@@ -22,6 +24,13 @@ public:
     void tests() {
         testTooManyArguments();
         testOSCMessageArgumentCompiler();
+        testQuantisedFadeBoundaries();
+        testMPSCRingQueue();
+        testOrderStatisticList();
+        testActionColumns();
+        testUndoJournal();
+        testBitsetRoundTrip();
+        testParallelFor();
         /*
         ArgumentEmbeddedPath sampleArgumentEmbeddedPath = {"/ch/", NonIter("chNum", "Channel Number", "Number of the Channel", 1, 1, 32), "/mix/fader"};
         ValueStorerArray sampleArgumentValues = {ValueStorer(2)};
@@ -53,6 +62,333 @@ public:
         }*/
     }
 
+    // A quantised fade should land on each step of the grid exactly at its boundary, going down as well as up. Walks
+    // a fade over a 10 step grid, each time jumping to when the fade engine would schedule the next step.
+    void testQuantisedFadeBoundaries() {
+        for (const bool descending: {true, false}) {
+            const int steps = 10;
+            const double start = descending ? 1.0 : 0.0;
+            const double end = descending ? 0.0 : 1.0;
+            const double durationMs = 1000.0;
+            int quantum = OSCFadeEngine::getQuantum(start, steps, descending);
+            jassert(quantum == (descending ? steps : 0));
+            while (quantum != (descending ? 0 : steps)) {
+                const std::chrono::duration<double, std::milli> due = OSCFadeEngine::getTimeOfNextQuantum(
+                    quantum, steps, start, end, durationMs);
+                const double valueWhenDue = start + (end - start) * due.count() / durationMs;
+                const int nextQuantum = OSCFadeEngine::getQuantum(valueWhenDue, steps, descending);
+                jassert(nextQuantum == quantum + (descending ? -1 : 1)); // Lagging (or skipping) a step
+                quantum = nextQuantum;
+            }
+        }
+        DBG("testQuantisedFadeBoundaries passed");
+    }
+
+    // Producers push through a ring of 4, so pushes keep spilling into the overflow list and back into the ring. Each
+    // producer's elements must come out in the order pushed, exactly once, and a batch must be poppable whole as soon
+    // as its first element is.
+    void testMPSCRingQueue() {
+        struct Item {
+            int producer;
+            int sequence;
+            int leftInBatch; // Elements of the same batch still to come
+        };
+        constexpr int producers = 4;
+        constexpr int perProducer = 20000;
+        constexpr int batchSize = 3;
+        MPSCRingQueue<Item> queue(4);
+
+        std::vector<std::thread> threads;
+        for (int producer = 0; producer < producers; producer++) {
+            threads.emplace_back([&queue, producer] {
+                for (int sequence = 0; sequence < perProducer;) {
+                    if (sequence % 4 == 0 && sequence + batchSize <= perProducer) {
+                        std::vector<Item> batch;
+                        for (int i = 0; i < batchSize; i++) {
+                            batch.push_back({producer, sequence + i, batchSize - 1 - i});
+                        }
+                        queue.pushBatch(batch.begin(), batch.end());
+                        sequence += batchSize;
+                    } else {
+                        queue.push({producer, sequence++, 0});
+                    }
+                }
+            });
+        }
+
+        std::vector<int> expected(producers, 0);
+        int received = 0;
+        int batchProducer = -1;
+        int leftInBatch = 0;
+        while (received < producers * perProducer) {
+            // The rest of a batch must already be there, so it's taken without waiting
+            auto item = leftInBatch > 0 ? queue.tryPop() : queue.popWait(std::chrono::milliseconds(100));
+            if (!item) {
+                jassert(leftInBatch == 0); // Only part of a batch was visible
+                continue;
+            }
+            jassert(item->sequence == expected[item->producer]); // Out of order, lost or duplicated
+            // A batch comes out contiguously, with nothing from another producer in between
+            jassert(leftInBatch == 0 || (item->producer == batchProducer && item->leftInBatch == leftInBatch - 1));
+            expected[item->producer]++;
+            received++;
+            batchProducer = item->producer;
+            leftInBatch = item->leftInBatch;
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        jassert(!queue.tryPop());
+
+        // interruptWait() wakes a popWait() on an empty queue, rather than leaving it to time out
+        std::thread interrupter([&queue] {
+            Thread::sleep(50);
+            queue.interruptWait();
+        });
+        const auto waitStartMs = Time::getMillisecondCounterHiRes();
+        const auto woken = queue.popWait(std::chrono::milliseconds(5000));
+        interrupter.join();
+        jassert(!woken && Time::getMillisecondCounterHiRes() - waitStartMs < 2500);
+        DBG("testMPSCRingQueue passed");
+    }
+
+    // Random inserts, moves and erases on an OrderStatisticList must leave it in the same order as a std::vector doing
+    // the same. Then checks the cue list's lookup by internal ID follows its inserts and erases.
+    void testOrderStatisticList() {
+        std::mt19937 random(42);
+        OrderStatisticList<int> list;
+        std::vector<int> model;
+        int nextKey = 0;
+        for (int operation = 0; operation < 20000; operation++) {
+            const auto choice = random() % 3;
+            if (choice == 0 || model.empty()) {
+                const auto index = random() % (model.size() + 1);
+                jassert(list.insert(index, nextKey));
+                jassert(!list.insert(index, nextKey)); // Keys are unique
+                model.insert(model.begin() + static_cast<std::ptrdiff_t>(index), nextKey++);
+            } else if (choice == 1) {
+                const auto oldIndex = random() % model.size();
+                const auto newIndex = random() % model.size();
+                list.move(oldIndex, newIndex);
+                const auto key = model[oldIndex];
+                model.erase(model.begin() + static_cast<std::ptrdiff_t>(oldIndex));
+                model.insert(model.begin() + static_cast<std::ptrdiff_t>(newIndex), key);
+            } else {
+                const auto index = random() % model.size();
+                jassert(list.erase(model[index]));
+                model.erase(model.begin() + static_cast<std::ptrdiff_t>(index));
+            }
+            jassert(list.size() == model.size());
+            if (operation % 100 == 0) {
+                jassert(std::equal(list.begin(), list.end(), model.begin(), model.end()));
+                for (size_t index = 0; index < model.size(); index++) {
+                    jassert(list.at(index) == model[index] && list.indexOf(model[index]) == index);
+                }
+            }
+        }
+        jassert(!list.contains(nextKey) && list.indexOf(nextKey) == OrderStatisticList<int>::npos);
+
+        CurrentCueInfoVector cciVector(std::vector<CurrentCueInfo>{});
+        for (int cue = 0; cue < 4; cue++) {
+            cciVector.push_back(CurrentCueInfo(String(cue), "Cue " + String(cue), "", {}));
+        }
+        const auto erasedID = cciVector[1].getInternalID();
+        cciVector.erase(1);
+        jassert(cciVector.getIndexByCCIInternalID(erasedID) == CurrentCueInfoVector::sizeTLimit);
+        for (size_t index = 0; index < cciVector.getSize(); index++) {
+            jassert(cciVector.getIndexByCCIInternalID(cciVector[index].getInternalID()) == index);
+        }
+        DBG("testOrderStatisticList passed");
+    }
+
+    /* Benchmarks whole-show scans of a synthetic show of 100k actions (10k cues of 10 fader moves across 32 channels),
+     * over each cue's CueOSCAction structs against over the show's ActionColumns. Both must find the same actions:
+     * every action on one address, and validation, where every 1000th action is sent to a channel past the last.
+     */
+    void testActionColumns() {
+        if (ID_TO_TEMPLATE_MAP.empty()) {
+            generateIDTemplateMap();
+        }
+        constexpr int cueCount = 10000;
+        constexpr int actionsPerCue = 10;
+        std::vector<CurrentCueInfo> ccis;
+        ccis.reserve(cueCount);
+        for (int cue = 0; cue < cueCount; cue++) {
+            std::vector<CueOSCAction> actions;
+            for (int action = 0; action < actionsPerCue; action++) {
+                const int actionNumber = cue * actionsPerCue + action;
+                const int channel = actionNumber % 1000 == 999 ? 40 : actionNumber % 32 + 1; // The X32 has 32
+                const auto address = "/ch/" + String(channel).paddedLeft('0', 2) + "/mix/fader";
+                if (action % 5 == 0) {
+                    actions.emplace_back(address, 1.f, Channel::FADER.NONITER, ValueStorer(-90.f), ValueStorer(-10.f),
+                                         Channel::FADER.ID);
+                } else {
+                    actions.emplace_back(address, Channel::FADER.NONITER, ValueStorer(-10.f), Channel::FADER.ID);
+                }
+            }
+            ccis.emplace_back(String(cue + 1), "Cue " + String(cue + 1), "", actions);
+        }
+        CurrentCueInfoVector show(ccis);
+        ccis.clear();
+        const InternedOSCAddress target(OSCAddressPattern("/ch/01/mix/fader"));
+
+        auto startMs = Time::getMillisecondCounterHiRes();
+        const auto &columns = show.getActionColumns();
+        const auto buildMs = Time::getMillisecondCounterHiRes() - startMs;
+        jassert(columns.size() == static_cast<size_t>(cueCount * actionsPerCue));
+
+        std::vector<ActionHandle> fromStructs, fromColumns;
+        startMs = Time::getMillisecondCounterHiRes();
+        for (const auto &cci: show) {
+            for (const auto &action: cci.actions) {
+                if (action.oscAddress == target) {
+                    fromStructs.push_back(action.handle);
+                }
+            }
+        }
+        const auto structScanMs = Time::getMillisecondCounterHiRes() - startMs;
+        startMs = Time::getMillisecondCounterHiRes();
+        columns.forEachActionOn(target, [&](size_t index) { fromColumns.push_back(columns.getHandles()[index]); });
+        const auto columnScanMs = Time::getMillisecondCounterHiRes() - startMs;
+        jassert(!fromStructs.empty() && fromStructs == fromColumns);
+
+        std::vector<ShowDiagnostic> perAction;
+        startMs = Time::getMillisecondCounterHiRes();
+        size_t cueIndex = 0;
+        for (const auto &cci: show) {
+            for (size_t actionIndex = 0; actionIndex < cci.actions.size(); actionIndex++) {
+                ShowValidator::validateAction(cci.actions[actionIndex], cueIndex, actionIndex, cci.getHandle(),
+                                              perAction);
+            }
+            cueIndex++;
+        }
+        const auto perActionMs = Time::getMillisecondCounterHiRes() - startMs;
+        startMs = Time::getMillisecondCounterHiRes();
+        const auto diagnostics = ShowValidator::validate(show);
+        const auto validateMs = Time::getMillisecondCounterHiRes() - startMs;
+        jassert(diagnostics.size() == static_cast<size_t>(cueCount * actionsPerCue / 1000));
+        jassert(diagnostics.size() == perAction.size());
+        for (size_t i = 0; i < std::min(diagnostics.size(), perAction.size()); i++) {
+            jassert(diagnostics[i].actionHandle == perAction[i].actionHandle &&
+                    diagnostics[i].message == perAction[i].message);
+        }
+
+        DBG("Action columns: built in " << buildMs << "ms. Address scan: " << structScanMs << "ms over structs, "
+            << columnScanMs << "ms over columns. Validation: " << perActionMs << "ms per action on one thread, "
+            << validateMs << "ms with columns");
+        DBG("testActionColumns passed");
+    }
+
+    // Erases, undoes and redoes on a small cue list, checking the cues (by handle) are back in order after each step.
+    // A new edit must clear the redo history, and only the last maxUndoSteps edits can be undone.
+    void testUndoJournal() {
+        std::vector<CurrentCueInfo> ccis;
+        for (int cue = 0; cue < 5; cue++) {
+            ccis.emplace_back(String(cue), "Cue " + String(cue), "", std::vector<CueOSCAction>{});
+        }
+        CurrentCueInfoVector cciVector(ccis);
+        const auto handlesOf = [&cciVector] {
+            std::vector<CueHandle> handles;
+            for (const auto &cci: cciVector) {
+                handles.push_back(cci.getHandle());
+            }
+            return handles;
+        };
+        const auto initial = handlesOf();
+        jassert(!cciVector.canUndo() && !cciVector.canRedo()); // Loading the cues isn't an edit
+
+        auto erased = initial;
+        erased.erase(erased.begin() + 2);
+        cciVector.erase(2);
+        jassert(handlesOf() == erased && cciVector.canUndo() && !cciVector.canRedo());
+        bool replayed = cciVector.undo();
+        jassert(replayed && handlesOf() == initial && !cciVector.canUndo() && cciVector.canRedo());
+        replayed = cciVector.redo();
+        jassert(replayed && handlesOf() == erased && cciVector.canUndo() && !cciVector.canRedo());
+        replayed = cciVector.undo();
+        jassert(replayed && handlesOf() == initial && cciVector.canRedo());
+
+        // history[k] is the list after k of the edits below
+        std::vector<std::vector<CueHandle>> history{initial};
+        const size_t edits = CurrentCueInfoVector::maxUndoSteps + 50;
+        for (size_t edit = 0; edit < edits; edit++) {
+            const auto size = cciVector.getSize();
+            if (edit % 3 == 0) {
+                cciVector.insert(edit % (size + 1), CurrentCueInfo(String(edit), "Inserted", "", {}));
+            } else if (edit % 3 == 1) {
+                cciVector.erase(edit * 5 % size);
+            } else {
+                cciVector.move(edit % size, (edit + 1) % size);
+            }
+            jassert(!cciVector.canRedo()); // A new edit clears the redo history
+            history.push_back(handlesOf());
+        }
+        size_t undone = 0;
+        while (cciVector.undo()) {
+            undone++;
+            jassert(handlesOf() == history[edits - undone]);
+        }
+        jassert(undone == CurrentCueInfoVector::maxUndoSteps);
+        for (size_t redone = 1; cciVector.redo(); redone++) {
+            jassert(handlesOf() == history[edits - undone + redone]);
+        }
+        jassert(handlesOf() == history.back() && !cciVector.canRedo());
+        DBG("testUndoJournal passed");
+    }
+
+    // A bitset argument is kept as a string of 0s and 1s. It must survive being exported to JSON and imported again,
+    // including the check of the argument against its template on import.
+    void testBitsetRoundTrip() {
+        const NonIter muteGroups("muteGroups", "Mute Groups", "Mute Group Switches",
+                                 std::vector<bool>{true, false, true, false, true, false});
+        CurrentCueInfoVector show(std::vector<CurrentCueInfo>{
+            {"1", "Mutes", "", {CueOSCAction("/config/mute", muteGroups, ValueStorer(std::string("101010")))}}
+        });
+        MemoryOutputStream output;
+        const auto written = ShowJSON::write(output, show, "Bitset Test", "");
+        jassert(written.wasOk());
+
+        MemoryInputStream input(output.getData(), output.getDataSize(), false);
+        ShowJSON::Reader reader(input);
+        std::vector<CurrentCueInfo> imported;
+        reader.onCue = [&imported](CurrentCueInfo &&cci) { imported.push_back(std::move(cci)); };
+        const auto result = reader.read();
+        jassert(result.wasOk()); // The import rejected the bitset
+        jassert(imported.size() == 1 && imported.front().actions.size() == 1);
+        const auto &action = imported.front().actions.front();
+        jassert(action.argument._meta_PARAMTYPE == STRING && action.argument.stringValue.toStdString() == "101010");
+        jassert(action.argumentTemplate.getNonIter() != nullptr &&
+                action.argumentTemplate.getNonIter()->_meta_PARAMTYPE == BITSET);
+        DBG("testBitsetRoundTrip passed");
+    }
+
+    // parallelFor() must call its body exactly once per index, from a worker below the count it was given, however the
+    // indexes end up split and stolen: a single index, fewer indexes than workers, and far more.
+    void testParallelFor() {
+        const size_t workers = std::max<size_t>(2, std::thread::hardware_concurrency());
+        for (const size_t count: {size_t{1}, workers - 1, size_t{10000}}) {
+            for (const size_t grainSize: {size_t{1}, size_t{7}, size_t{64}}) {
+                std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[count]);
+                for (size_t index = 0; index < count; index++) {
+                    visits[index].store(0);
+                }
+                std::atomic<bool> badWorker{false};
+                parallelFor(count, grainSize, workers, [&](size_t index, size_t worker) {
+                    if (worker >= workers) {
+                        badWorker.store(true);
+                    }
+                    visits[index].fetch_add(1);
+                });
+                jassert(!badWorker.load());
+                for (size_t index = 0; index < count; index++) {
+                    const auto visited = visits[index].load();
+                    jassert(visited == 1); // Skipped or repeated by a steal
+                }
+            }
+        }
+        DBG("testParallelFor passed");
+    }
+
     void testTooManyArguments() {
         /*
         if (false) {
@@ -108,6 +444,12 @@ public:
     {
         // This method is where you should put your application's initialisation code..
         // oscDevSelWin.reset(new OSCDeviceSelectorWindow("OSC Device Selector"));
+        if (commandLine.contains("--run-tests")) {
+            // Checks are jasserts, so run a debug build
+            tests();
+            quit();
+            return;
+        }
         mainWindow.reset(new MainWindow("XM32CE"));
     }
 
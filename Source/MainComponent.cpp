@@ -19,6 +19,16 @@ MainComponent::MainComponent(): cueListModel(cueListBox, cueListData), oscDevice
 
     cueListBox.setModel(&cueListModel);
 
+    cueFilterBox.setTextToShowWhenEmpty("Filter: words, template IDs, /ch/12...", UICfg::LIGHT_BG_COLOUR);
+    cueFilterBox.setColour(TextEditor::ColourIds::backgroundColourId, UICfg::BG_SECONDARY_COLOUR);
+    cueFilterBox.setColour(TextEditor::ColourIds::outlineColourId, UICfg::TRANSPARENT);
+    cueFilterBox.setColour(TextEditor::ColourIds::textColourId, UICfg::TEXT_COLOUR);
+    cueFilterBox.onTextChange = [this] { filterCueList(); };
+    cueFilterBox.onEscapeKey = [this] {
+        cueFilterBox.setText({}); // Sends onTextChange
+        grabKeyboardFocus(); // Back to the show's key commands
+    };
+
     commandOccurred(FULL_SHOW_RESET);
 
     for (auto *comp: activeComps) {
@@ -29,11 +39,48 @@ MainComponent::MainComponent(): cueListModel(cueListBox, cueListData), oscDevice
         generateIDTemplateMap();
     }
 
+    autosave.onFailure = [](const String &reason) {
+        MessageManager::callAsync([reason] {
+            AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Autosave Disabled",
+                                             reason + ".\n\nEdits from now on won't be restored if XM32CE closes "
+                                             "unexpectedly, so save the show yourself.", "Ok");
+        });
+    };
+    // An autosave is only left behind when the last run didn't close cleanly. Needs the template map, so goes after it.
+    bool startAutosave = true;
+    if (AutosaveJournal::hasAutosave(autosaveDirectory)) {
+        std::vector<CurrentCueInfo> recoveredCCIs;
+        String showName, showDescription;
+        if (const auto result = AutosaveJournal::recover(autosaveDirectory, recoveredCCIs, showName, showDescription);
+            result.wasOk()) {
+            replaceShow(std::move(recoveredCCIs), showName, showDescription);
+            AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon, "Show Recovered",
+                                             "XM32CE didn't close properly last time, so the show has been restored "
+                                             "from its autosave.", "Ok");
+        } else {
+            // Starting the autosave would replace the one that couldn't be recovered, so it's moved out of the way
+            const auto keptIn = AutosaveJournal::setAside(autosaveDirectory);
+            startAutosave = keptIn != File();
+            AlertWindow::showMessageBoxAsync(
+                AlertWindow::WarningIcon, "Couldn't Recover Show",
+                "XM32CE didn't close properly last time, but its autosave couldn't be restored: " +
+                result.getErrorMessage() + "\n\n" +
+                (startAutosave ? "The autosave has been kept in " + keptIn.getFullPathName() + "."
+                               : "The autosave in " + autosaveDirectory.getFullPathName() + " couldn't be moved "
+                                 "aside, so autosave is off for this run to keep it."), "Ok");
+        }
+    }
+    if (startAutosave) {
+        autosave.start();
+    }
+
     auto uuid = uuidGen.generate();
     cciConstructorWindows[uuid].reset(new OSCCCIConstructor(uuid, "CCI Constructor"));
     cciConstructorWindows[uuid].get()->setParentListener(this);
 
-    oscDevSelWin.reset(new OSCDeviceSelectorWindow());
+    const bool bundleCommands = settings.getBoolValue(bundleCommandsSetting);
+    dispatcher.setBundlingEnabled(bundleCommands);
+    oscDevSelWin.reset(new OSCDeviceSelectorWindow(bundleCommands));
     oscDevSelWin->setNewListener(this);
 }
 
@@ -106,6 +153,9 @@ void MainComponent::resized() {
 
     g.drawText("No", numBox.reduced(padding), Justification::centred, true);
     g.drawText("Cue ID", idBox.reduced(padding), Justification::centredLeft, true);
+    // The filter box takes the right half of the name column's header
+    cueFilterBox.setBounds(nameBox.removeFromRight(nameBox.getWidth() / 2).reduced(padding));
+    cueFilterBox.applyFontToAllText(UICfg::DEFAULT_MONOSPACE_FONT.withHeight(cueFilterBox.getHeight() * 0.7f));
     g.drawText("Cue Name", nameBox.reduced(padding), Justification::centredLeft, true);
     g.drawText("#A", numberOfActionsBox.reduced(padding), Justification::centred, true);
     g.drawText("Status", stateBox.reduced(padding), Justification::centred, true);
@@ -122,7 +172,7 @@ void MainComponent::updateActiveShowOptionsFromCCIIndex(size_t newIndex) {
         activeShowOptions.currentCueID = "";
         activeShowOptions.currentCuePlaying = false;
         activeShowOptions.numberOfCueItems = 0;
-        activeShowOptions.currentCueInternalID = "";
+        activeShowOptions.currentCueHandle = {};
         return;
     }
 
@@ -131,9 +181,9 @@ void MainComponent::updateActiveShowOptionsFromCCIIndex(size_t newIndex) {
 
     activeShowOptions.currentCueIndex = newIndex;
     activeShowOptions.currentCueID = cci.id;
-    activeShowOptions.currentCuePlaying = cci.currentlyPlaying;
+    activeShowOptions.currentCuePlaying = cciVector.isPlaying(cci.getHandle());
     activeShowOptions.numberOfCueItems = ccisInfoSize;
-    activeShowOptions.currentCueInternalID = cci.getInternalID();
+    activeShowOptions.currentCueHandle = cci.getHandle();
 }
 
 
@@ -160,11 +210,11 @@ void MainComponent::commandOccurred(ShowCommand cmd) {
                 return;
             }
 
-            cci.currentlyPlaying = true;
             activeShowOptions.currentCuePlaying = true;
 
-            dispatcher.addCueToMessageQueue(cci);
+            // Marked running first, so no completion can arrive for an action that isn't counted yet
             cciVector.setAsRunning(cci);
+            dispatcher.addCueToMessageQueue(cci);
             currentCueListItemRequiresRedraw = true;
             break;
         }
@@ -172,7 +222,6 @@ void MainComponent::commandOccurred(ShowCommand cmd) {
             auto &cci = cciVector.getCurrentCueInfoByIndex(activeShowOptions.currentCueIndex);
             if (cci.isInvalid()) { break; }
 
-            cci.currentlyPlaying = false;
             activeShowOptions.currentCuePlaying = false;
 
             dispatcher.stopAllActionsInCCI(cci);
@@ -181,8 +230,14 @@ void MainComponent::commandOccurred(ShowCommand cmd) {
             break;
         }
         case SHOW_NAME_CHANGE:
-        case FULL_SHOW_RESET:
             break; // Don't need to do anything, but we still need to broadcast it to all callbacks.
+        case FULL_SHOW_RESET:
+            // The whole show may have been replaced (e.g., a show was loaded), taking the current cue with it.
+            if (!cciVector.cciInVector(activeShowOptions.currentCueHandle)) {
+                updateActiveShowOptionsFromCCIIndex(0);
+            }
+            cueListBox.updateContent();
+            break;
         case CUES_ADDED:
             activeShowOptions.numberOfCueItems = cciVector.getSize();
             break;
@@ -193,7 +248,7 @@ void MainComponent::commandOccurred(ShowCommand cmd) {
                 updateActiveShowOptionsFromCCIIndex(0);
                 break;
             }
-            if (cciVector.cciInVector(activeShowOptions.currentCueInternalID)) {
+            if (cciVector.cciInVector(activeShowOptions.currentCueHandle)) {
                 // The CCI has NOT been deleted from the vector.
                 setNewIndexForCCI();
                 break;
@@ -215,11 +270,44 @@ void MainComponent::commandOccurred(ShowCommand cmd) {
 }
 
 
-void MainComponent::sendCueCommandToAllListeners(const ShowCommand command, const std::string &cciInternalID,
+void MainComponent::cuesEdited(const CueEditSummary& edit) {
+    const bool wasEmpty = activeShowOptions.numberOfCueItems == 0;
+    if (cciVector.cciInVector(activeShowOptions.currentCueHandle)) {
+        // The current cue survived the edit; it may just have shifted.
+        setNewIndexForCCI();
+        activeShowOptions.numberOfCueItems = cciVector.getSize();
+    } else {
+        // The current cue was deleted (or there wasn't one). Land on the first cue the edit touched.
+        const auto size = cciVector.getSize();
+        updateActiveShowOptionsFromCCIIndex(size == 0 ? 0 : std::min(edit.firstAffectedIndex, size - 1));
+    }
+
+    ShowCommand cmd = CUE_INDEXS_CHANGED;
+    if (wasEmpty && activeShowOptions.numberOfCueItems != 0) {
+        cmd = FULL_SHOW_RESET; // See the note on activeShowOptions
+    } else if (edit.cuesDeleted > 0) {
+        cmd = CUES_DELETED;
+    } else if (edit.cuesAdded > 0) {
+        cmd = CUES_ADDED;
+    }
+    sendCommandToAllListeners(cmd);
+
+    const MessageManagerLock mmLock;
+    if (!mmLock.lockWasGained()) {
+        jassertfalse; // Woah woah woah... where's our message lock?
+    }
+    cueListBox.updateContent();
+    for (auto row = edit.firstAffectedIndex; row <= edit.lastAffectedIndex; row++) {
+        cueListBox.repaintRow(static_cast<int>(row));
+    }
+}
+
+
+void MainComponent::sendCueCommandToAllListeners(const ShowCommand command, const CueHandle cciHandle,
                                                  const size_t cciCurrentIndex) const {
     for (auto *comp: callbackCompsUponActiveShowOptionsChanged) {
         if (comp != nullptr) {
-            comp->cueCommandOccurred(command, cciInternalID, cciCurrentIndex);
+            comp->cueCommandOccurred(command, cciHandle, cciCurrentIndex);
             continue;
         }
         jassertfalse;
@@ -258,12 +346,19 @@ void MainComponent::oscDevSelClosed() {
     }
     oscDevSelWin.reset();
     oscDeviceSender.setNewDevice(dev);
+    dispatcher.setBundlingEnabled(dev.bundleCommands);
+    settings.setValue(bundleCommandsSetting, dev.bundleCommands);
+    if (!settings.saveIfNeeded()) {
+        DBG("Couldn't save settings to " + settings.getFile().getFullPathName());
+    }
+    // Last chance to catch a bad action before the show goes live
+    checkShow("Problems in the Show");
 }
 
 
-void MainComponent::cueCommandOccurred(ShowCommand command, std::string cciInternalID, size_t cciCurrentIndex) {
+void MainComponent::cueCommandOccurred(ShowCommand command, CueHandle cciHandle, size_t cciCurrentIndex) {
     bool cueListItemRequiresRedraw = true;
-    if (cciInternalID == activeShowOptions.currentCueInternalID) {
+    if (cciHandle == activeShowOptions.currentCueHandle) {
         cueListItemRequiresRedraw = false;
         // When a cue command is morphed and passed to commandOccurred, it should handle the redraw
         // Ok so, we also have to pass this command to commandOccurred(), but first we need to morph it.
@@ -299,44 +394,44 @@ void MainComponent::cueCommandOccurred(ShowCommand command, std::string cciInter
         if (cueListItemRequiresRedraw) {
             cueListBox.repaintRow(cciCurrentIndex); // Any event that occurs must be redrawn
         }
-        sendCueCommandToAllListeners(command, cciInternalID, cciCurrentIndex);
+        sendCueCommandToAllListeners(command, cciHandle, cciCurrentIndex);
     } // Force message manager lock to be released here, so that we can call this function from any thread.
 }
 
 
-void MainComponent::actionFinished(std::string actionID) {
-    auto remaining = cciVector.removeFromRunning(actionID);
-    if (remaining == CurrentCueInfoVector::sizeTLimit) {
-        // Oh no... we done goofed up.
-        // Let's just... pretend nothing happened.
-        // We're only returning without jassert because removeFromRunning should've already jasserted.
+void MainComponent::actionFinished(ActionHandle actionHandle) {
+    // Called on the dispatcher thread, so only the lock-free run state is touched here. Anything needing the cue list
+    // itself is handed to the message thread, where the list is edited.
+    CueHandle cciHandle;
+    const auto remaining = cciVector.removeFromRunning(actionHandle, &cciHandle);
+    if (remaining != 0) {
+        // Either other actions in the CCI are still running, or this action had already been stopped (e.g., by
+        // SHOW_STOP, or by its CCI being deleted) and the CCI was reported stopped then.
         return;
     }
-    if (remaining == 0) {
-        // Wait... that's the last action running for the CCI!
-        // Let's update the active show options to reflect that the current cue is no longer playing.
-        // First, find the CCI internal ID for the action ID
-        const auto cciInternalID = cciVector.getParentCCIInternalID(actionID);
-        if (cciInternalID.empty()) {
-            jassertfalse; // Invalid CCI Internal ID. That means it wasn't in the actionIDtoCCIInternalIDMap.
-            return;
-        }
-        // Now, find the index of the CCI internal ID in the cciIDtoIndexMap
-        size_t cciIndex = cciVector.getIndexByCCIInternalID(cciInternalID);
-        if (cciIndex == CurrentCueInfoVector::sizeTLimit) {
-            jassertfalse; // Invalid CCI Index. That means it wasn't in the cciIDtoIndexMap.
-            return;
+    // Wait... that's the last action running for the CCI!
+    MessageManager::callAsync([safeThis = SafePointer<MainComponent>(this), cciHandle] {
+        if (safeThis != nullptr) {
+            safeThis->cueFinished(cciHandle);
         }
+    });
+}
 
-        // Now, set CCI as not playing
-        auto &cci = cciVector.getCurrentCueInfoByIndex(cciIndex);
-        cci.currentlyPlaying = false;
-        if (cciIndex == activeShowOptions.currentCueIndex) {
-            activeShowOptions.currentCuePlaying = false;
-        }
-        // Call the listener... the cueCommandOccurred listener will pass on a SHOW_STOP ShowCommand if the CCI is the current CCI.
-        cueCommandOccurred(CUE_STOPPED, cci.getInternalID(), cciIndex);
+
+void MainComponent::cueFinished(CueHandle cciHandle) {
+    if (cciVector.isPlaying(cciHandle)) {
+        return; // Played again since its last action finished
+    }
+    dispatcher.cueFinished(cciHandle);
+    const size_t cciIndex = cciVector.getIndexByCCIHandle(cciHandle);
+    if (cciIndex == CurrentCueInfoVector::sizeTLimit) {
+        return; // Deleted since its last action finished
+    }
+    if (cciIndex == activeShowOptions.currentCueIndex) {
+        activeShowOptions.currentCuePlaying = false;
     }
+    // Call the listener... the cueCommandOccurred listener will pass on a SHOW_STOP ShowCommand if the CCI is the current CCI.
+    cueCommandOccurred(CUE_STOPPED, cciHandle, cciIndex);
 }
 
 
@@ -347,7 +442,6 @@ void MainComponent::closeRequested(WindowType windowType, std::string uuid) {
             break;
         }
         case AppComponents_OSCCCIConstructor:
-            // TODO: Implement
             auto it = cciConstructorWindows.find(uuid);
             if (it == cciConstructorWindows.end()) {
                 jassertfalse; // Invalid window close request passed on improperly registered parent component
@@ -355,6 +449,9 @@ void MainComponent::closeRequested(WindowType windowType, std::string uuid) {
             }
             auto cci = it->second->getCompiledCCI();
             cciConstructorWindows.erase(uuid);
+            if (!cci.isInvalid()) {
+                cciVector.push_back(cci);
+            }
             break;
     }
 }
@@ -387,11 +484,173 @@ bool MainComponent::keyPressed(const KeyPress &key, Component *originatingCompon
         if (activeShowOptions.currentCueIndex + 1 < activeShowOptions.numberOfCueItems) {
             commandOccurred(SHOW_NEXT_CUE);
         }
+    } else if (key == KeyPress('z', ModifierKeys::commandModifier, 0)) {
+        cciVector.undo();
+    } else if (key == KeyPress('z', ModifierKeys::commandModifier | ModifierKeys::shiftModifier, 0) ||
+               key == KeyPress('y', ModifierKeys::commandModifier, 0)) {
+        cciVector.redo();
+    } else if (key == KeyPress('r', ModifierKeys::commandModifier, 0)) {
+        restoreTrackedState();
+    } else if (key == KeyPress('s', ModifierKeys::commandModifier, 0)) {
+        showFileChooser = std::make_unique<FileChooser>("Save Show", File(), "*.xm32show;*.json");
+        showFileChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::warnAboutOverwriting,
+                                     [this](const FileChooser &chooser) {
+                                         auto file = chooser.getResult();
+                                         if (file == File()) { return; }
+                                         if (!file.hasFileExtension("json")) {
+                                             file = file.withFileExtension("xm32show");
+                                         }
+                                         saveShow(file);
+                                     });
+    } else if (key == KeyPress('o', ModifierKeys::commandModifier, 0)) {
+        showFileChooser = std::make_unique<FileChooser>("Open Show", File(), "*.xm32show;*.json");
+        showFileChooser->launchAsync(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles,
+                                     [this](const FileChooser &chooser) {
+                                         if (chooser.getResult().existsAsFile()) {
+                                             loadShow(chooser.getResult());
+                                         }
+                                     });
+    }
+    return true;
+}
+
+
+bool MainComponent::saveShow(const File &file) {
+    const auto result = file.hasFileExtension("json")
+                            ? ShowJSON::write(file, cciVector, activeShowOptions.showName,
+                                              activeShowOptions.showDescription)
+                            : ShowFile::write(file, cciVector, activeShowOptions.showName,
+                                              activeShowOptions.showDescription);
+    if (result.failed()) {
+        AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Couldn't Save Show", result.getErrorMessage(), "Ok");
+        return false;
     }
     return true;
 }
 
 
+bool MainComponent::loadShow(const File &file) {
+    if (file.hasFileExtension("json")) {
+        if (showImport != nullptr && showImport->isThreadRunning()) {
+            jassertfalse; // The progress window is modal, so a second import shouldn't be possible
+            return false;
+        }
+        showImport = std::make_unique<ShowImportWindow>(
+            file, [this](const Result &result, std::vector<CurrentCueInfo> &&loadedCCIs, const String &showName,
+                         const String &showDescription) {
+                finishLoadingShow(result, std::move(loadedCCIs), showName, showDescription);
+            });
+        showImport->launchThread();
+        return true;
+    }
+    ShowFile showFile;
+    const auto result = showFile.open(file);
+    std::vector<CurrentCueInfo> loadedCCIs;
+    size_t droppedActions = 0;
+    if (result.wasOk()) {
+        loadedCCIs = showFile.buildCues(droppedActions);
+    }
+    finishLoadingShow(result, std::move(loadedCCIs), showFile.getShowName(), showFile.getShowDescription());
+    if (droppedActions > 0) {
+        // The rest of the show is fine, so it stays loaded, but the user has to know what's missing from it
+        AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Show Partly Loaded",
+                                         String(static_cast<int64>(droppedActions)) + " actions in " +
+                                         file.getFileName() + " are damaged and have been left out. Check the "
+                                         "show before running it.", "Ok");
+    }
+    return result.wasOk();
+}
+
+
+void MainComponent::finishLoadingShow(const Result &result, std::vector<CurrentCueInfo> &&loadedCCIs,
+                                      const String &showName, const String &showDescription) {
+    if (result.failed()) {
+        AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Couldn't Open Show", result.getErrorMessage(), "Ok");
+        return;
+    }
+    replaceShow(std::move(loadedCCIs), showName, showDescription);
+}
+
+
+void MainComponent::replaceShow(std::vector<CurrentCueInfo> newCCIs, const String &showName,
+                                const String &showDescription) {
+    // Nothing from the old show may keep running once its cues are gone
+    dispatcher.stopAllActions();
+    // Named first, so the autosave snapshot taken on reset has the new name
+    activeShowOptions.showName = showName;
+    activeShowOptions.showDescription = showDescription;
+    cciVector.reset(std::move(newCCIs)); // Sends FULL_SHOW_RESET
+    sendCommandToAllListeners(SHOW_NAME_CHANGE);
+    checkShow("Problems in the Loaded Show");
+}
+
+
+void MainComponent::checkShow(const String &title) {
+    const auto diagnostics = ShowValidator::validate(cciVector);
+    if (diagnostics.empty()) {
+        return;
+    }
+    // A show can have far more problems than fit in an alert, so every one is listed in a scrollable box instead
+    auto list = std::make_unique<TextEditor>();
+    list->setReadOnly(true);
+    list->setMultiLine(true);
+    list->setCaretVisible(false);
+    list->setScrollbarsShown(true);
+    list->setText(ShowValidator::summarise(diagnostics, diagnostics.size()), false);
+    list->setSize(600, 300);
+
+    DialogWindow::LaunchOptions options;
+    options.content.setOwned(list.release());
+    options.dialogTitle = title;
+    options.dialogBackgroundColour = getLookAndFeel().findColour(ResizableWindow::backgroundColourId);
+    options.componentToCentreAround = this;
+    options.escapeKeyTriggersCloseButton = true;
+    options.resizable = true;
+    options.launchAsync();
+}
+
+
+void MainComponent::restoreTrackedState() {
+    const auto state = stateTracker.getStateBefore(activeShowOptions.currentCueIndex);
+    std::vector<OSCCueDispatcherManager::AddressedPacket> packets;
+    state.forEach([this, &packets](uint32, const TrackedValue &tracked) {
+        // The action that set the value knows its template, so it can build the message
+        const auto cciIndex = cciVector.getIndexByCCIHandle(tracked.cue);
+        if (cciIndex == CurrentCueInfoVector::sizeTLimit) {
+            jassertfalse; // The tracker is out of step with the cue list
+            return;
+        }
+        for (const auto &action: cciVector.getCurrentCueInfoByIndex(cciIndex).actions) {
+            if (action.handle != tracked.action) {
+                continue;
+            }
+            if (action.oat == OAT_COMMAND) {
+                jassert(action.compiledPacket != nullptr);
+                packets.push_back({action.oscAddress, action.compiledPacket});
+            } else {
+                // A fade leaves its address on its end value, so send that straight away
+                packets.push_back({action.oscAddress, CueOSCAction::compileCommandPacket(
+                                       action.oscAddress, action.argumentTemplate, tracked.value)});
+            }
+            return;
+        }
+        jassertfalse; // The action isn't in the cue the tracker says it is
+    });
+    dispatcher.sendPackets(std::move(packets));
+}
+
+
+void MainComponent::filterCueList() {
+    cueListData.setFilter(cueFilterBox.getText());
+    if (cueListData.isFiltering()) {
+        if (const auto first = cueListData.getFirstFilterMatchIndex(); first != CurrentCueInfoVector::sizeTLimit) {
+            cueListBox.scrollToEnsureRowIsOnscreen(static_cast<int>(first));
+        }
+    }
+    cueListBox.repaint();
+}
+
+
 // ==========================================================================
 
 
@@ -425,10 +684,11 @@ void CueListData::paintContents(int rowNum, Graphics &g, Rectangle<int> bounds)
     g.drawText(cci.id, idBox.reduced(padding), Justification::centredLeft);
     g.drawText(cci.name, nameBox.reduced(padding), Justification::centredLeft);
     g.drawText(String(cci.actions.size()), numberOfActionsBox.reduced(padding), Justification::centred);
-    g.setColour(cci.currentlyPlaying ? UICfg::POSITIVE_BUTTON_COLOUR : UICfg::NEGATIVE_BUTTON_COLOUR);
+    const bool playing = cciVector.isPlaying(cci.getHandle());
+    g.setColour(playing ? UICfg::POSITIVE_BUTTON_COLOUR : UICfg::NEGATIVE_BUTTON_COLOUR);
     g.fillRect(stateBox);
     g.setColour(UICfg::TEXT_COLOUR);
-    g.drawText(cci.currentlyPlaying ? "PLAYING" : "STOPPED", stateBox.reduced(padding), Justification::centred);
+    g.drawText(playing ? "PLAYING" : "STOPPED", stateBox.reduced(padding), Justification::centred);
     // g.drawText(, numberOfActionsBox, Justification::centred);
 
     // Draw boxes for all rectangles
@@ -442,6 +702,11 @@ void CueListData::paintContents(int rowNum, Graphics &g, Rectangle<int> bounds)
     g.setColour(UICfg::CUE_LIST_ITEM_OUTLINE_COLOUR);
     g.drawRect(bounds);
 
+    if (!matchesFilter(cci.getHandle())) {
+        g.setColour(UICfg::BG_SECONDARY_COLOUR.withAlpha(0.75f));
+        g.fillRect(bounds);
+    }
+
     // .getInternalID() )
 }
 
@@ -456,7 +721,7 @@ void CueListItem::paint(Graphics &g) {
 
         goToCueBtn = std::make_unique<GoToCueBtn>();
         goToCueBtn->onClick = [=]() {
-            data.notifyCueListeners(JUMP_TO_CUE, cci.getInternalID(), rowNum);
+            data.notifyCueListeners(JUMP_TO_CUE, cci.getHandle(), rowNum);
         };
 
 
@@ -582,7 +847,7 @@ String CCIActionList::getWidthAdjustedArgumentValueString(const ValueStorer &val
     String typeAlias;
     switch (type) {
         case STRING:
-            valueAsString = value.stringValue;
+            valueAsString = value.stringValue.toStdString();
             typeAlias = "s";
             break;
         case INT:
@@ -699,15 +964,15 @@ void CCIActionList::commandOccurred(ShowCommand command) {
         case SHOW_PREVIOUS_CUE:
         case FULL_SHOW_RESET:
             repaint();
-            lastRenderedCCIInternalID = getCCI().getInternalID();
+            lastRenderedCCIHandle = getCCI().getHandle();
             break;
         case CUES_ADDED:
         case CUES_DELETED: {
             // If the previous CCI was different, repaint().
             auto &cci = getCCI();
-            if (cci.getInternalID() != lastRenderedCCIInternalID) {
+            if (cci.getHandle() != lastRenderedCCIHandle) {
                 repaint();
-                lastRenderedCCIInternalID = cci.getInternalID();
+                lastRenderedCCIHandle = cci.getHandle();
             }
             break;
         }
@@ -780,16 +1045,15 @@ void CCIActionList::paint(Graphics &g) {
         switch (action.oat) {
             case OAT_COMMAND: {
                 // For OAT_COMMAND, we previously could have multiple parameters. THIS IS NOT TRUE ANYMORE!
-                // Make a copy of the current template. Sacrifice the memory, not the compiler.
-                OSCMessageArguments currentTemplate = action.oatCommandOSCArgumentTemplate;
+                const auto &currentTemplate = action.argumentTemplate;
 
                 // Figure out which template type this is to get the verbose name
                 String verboseName;
-                if (auto *optVal = std::get_if<OptionParam>(&currentTemplate)) {
+                if (auto *optVal = currentTemplate.getOptionParam()) {
                     verboseName = optVal->verboseName;
-                } else if (auto *enumVal = std::get_if<EnumParam>(&currentTemplate)) {
+                } else if (auto *enumVal = currentTemplate.getEnumParam()) {
                     verboseName = enumVal->verboseName;
-                } else if (auto *nonIter = std::get_if<NonIter>(&currentTemplate)) {
+                } else if (auto *nonIter = currentTemplate.getNonIter()) {
                     verboseName = nonIter->verboseName;
                 }
 
@@ -806,10 +1070,10 @@ void CCIActionList::paint(Graphics &g) {
             }
             case OAT_FADE: {
                 // Required as getWidthAdjustedVerboseName requires juce::String&, not std::string
-                String verboseName = action.oscArgumentTemplate.verboseName;
+                String verboseName = action.getFadeTemplate().verboseName;
                 String idealArgumentValueStr;
                 String typeAlias = "?";
-                switch (action.oscArgumentTemplate._meta_PARAMTYPE) {
+                switch (action.getFadeTemplate()._meta_PARAMTYPE) {
                     case INT: {
                         idealArgumentValueStr = String(action.startValue.intValue) + " >> " + String(
                                                     action.endValue.intValue);
@@ -1003,11 +1267,11 @@ void CCISidePanel::selectedCueChanged() {
     repaint();
     auto &cci = cciVector.getCurrentCueInfoByIndex(activeShowOptions.currentCueIndex);
     if (cci.isInvalid()) {
-        lastCCIInternalID = "";
+        lastCCIHandle = {};
         return;
     }
     // Assumes currentCueIndex is valid!
-    lastCCIInternalID = cci.getInternalID();
+    lastCCIHandle = cci.getHandle();
 }
 
 
@@ -1036,7 +1300,7 @@ void CCISidePanel::commandOccurred(const ShowCommand command) {
             // If the cue deleted is this one... then we need to update the side panel.
             auto &cci = cciVector.getCurrentCueInfoByIndex(activeShowOptions.currentCueIndex);
             if (cci.isInvalid() || // If no cues... or
-                cci.getInternalID() != lastCCIInternalID) {
+                cci.getHandle() != lastCCIHandle) {
                 // If the current cue is not the last one we had
                 commandOccurred(SHOW_NEXT_CUE); // Triggers a repaint, resize and reimage
             }
@@ -1050,7 +1314,7 @@ void CCISidePanel::commandOccurred(const ShowCommand command) {
     }
 }
 
-void CCISidePanel::cueCommandOccurred(ShowCommand command, std::string cciInternalID, size_t cciCurrentIndex) {
+void CCISidePanel::cueCommandOccurred(ShowCommand command, CueHandle cciHandle, size_t cciCurrentIndex) {
     switch (command) {
         case JUMP_TO_CUE:
             selectedCueChanged();
@@ -1347,7 +1611,7 @@ void HeaderBar::commandOccurred(const ShowCommand command) {
     }
 }
 
-void HeaderBar::cueCommandOccurred(ShowCommand command, std::string cciInternalID, size_t cciCurrentIndex) {
+void HeaderBar::cueCommandOccurred(ShowCommand command, CueHandle cciHandle, size_t cciCurrentIndex) {
     switch (command) {
         case JUMP_TO_CUE:
             selectedCueChanged();
@@ -1356,3 +1620,33 @@ void HeaderBar::cueCommandOccurred(ShowCommand command, std::string cciInternalI
             break;
     }
 }
+
+
+//==============================================================================
+
+
+ShowImportWindow::ShowImportWindow(const File &file, FinishedCallback onFinished):
+    ThreadWithProgressWindow("Importing " + file.getFileName(), true, false), file(file),
+    onFinished(std::move(onFinished)) {}
+
+
+void ShowImportWindow::run() {
+    FileInputStream input(file);
+    if (input.failedToOpen()) {
+        result = input.getStatus();
+        return;
+    }
+    ShowJSON::Reader reader(input);
+    reader.onCue = [this](CurrentCueInfo &&cci) { loadedCCIs.push_back(std::move(cci)); };
+    reader.onProgress = [this](double fraction) { setProgress(fraction); };
+    result = reader.read();
+    showName = reader.getShowName();
+    showDescription = reader.getShowDescription();
+}
+
+
+void ShowImportWindow::threadComplete(bool) {
+    if (onFinished != nullptr) {
+        onFinished(result, std::move(loadedCCIs), showName, showDescription);
+    }
+}
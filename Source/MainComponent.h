@@ -3,6 +3,11 @@
 #include "OSCMan.h"
 #include "Helpers.h"
 #include "AppComponents.h"
+#include "ShowFile.h"
+#include "ShowJSON.h"
+#include "AutosaveJournal.h"
+#include "ShowValidator.h"
+#include "CueStateTracker.h"
 #include <chrono>
 #include <ctime>
 
@@ -37,7 +42,7 @@ struct CueListData: public DraggableListBoxItemData {
     int getNumItems() override { return cciVector.getSize(); }
 
     void deleteItem(int index) override {
-        cciVector.erase(cciVector.begin() + index);
+        cciVector.erase(index);
     }
 
     // Not to be used as the virtual method does not provide enough info
@@ -62,6 +67,35 @@ struct CueListData: public DraggableListBoxItemData {
     }
 
 
+    // Dims the rows of cues not matching filter (see CueSearchIndex::search()). Rows are dimmed rather than hidden,
+    // so a row's number stays its cue's index. An empty filter dims nothing.
+    void setFilter(const String &newFilter) {
+        filter = newFilter.trim();
+        filterMatchesStale = true;
+    }
+
+    [[nodiscard]] bool isFiltering() const { return filter.isNotEmpty(); }
+
+    // True if the cue matches the filter, or there is no filter
+    bool matchesFilter(CueHandle cciHandle) {
+        if (!isFiltering()) {
+            return true;
+        }
+        refreshFilterMatches();
+        return filterMatches.count(cciHandle) > 0;
+    }
+
+    // Returns CurrentCueInfoVector::sizeTLimit if no cue matches the filter
+    size_t getFirstFilterMatchIndex() {
+        refreshFilterMatches();
+        size_t first = CurrentCueInfoVector::sizeTLimit;
+        for (const auto &cciHandle: filterMatches) {
+            first = std::min(first, cciVector.getIndexByCCIHandle(cciHandle));
+        }
+        return first;
+    }
+
+
 
     // Sends ShowCommand to registered listeners
     void notifyListeners(ShowCommand command) {
@@ -74,10 +108,10 @@ struct CueListData: public DraggableListBoxItemData {
         }
     }
     // Sends cueCommandOccurred to registered listeners
-    void notifyCueListeners(ShowCommand command, std::string cciInternalID, size_t cciCurrentIndex) {
+    void notifyCueListeners(ShowCommand command, CueHandle cciHandle, size_t cciCurrentIndex) {
         for (auto lstnr: listeners) {
             if (lstnr != nullptr) {
-                lstnr->cueCommandOccurred(command, cciInternalID, cciCurrentIndex);
+                lstnr->cueCommandOccurred(command, cciHandle, cciCurrentIndex);
             } else {
                 jassertfalse; // Listener is null, this should never happen
             }
@@ -85,6 +119,22 @@ struct CueListData: public DraggableListBoxItemData {
     }
 private:
     std::vector<ShowCommandListener*> listeners;
+
+    String filter;
+    CueSearchIndex::Matches filterMatches;
+    uint64 filterMatchesVersion{0}; // The search index's version when filterMatches was found
+    bool filterMatchesStale{true};
+
+    // Searches again if the filter or the cues have changed since the last search. Every row is painted with the
+    // same result, so this only searches once per keystroke or edit.
+    void refreshFilterMatches() {
+        const auto version = cciVector.getSearchIndex().getVersion();
+        if (filterMatchesStale || version != filterMatchesVersion) {
+            filterMatches = cciVector.getSearchIndex().search(filter);
+            filterMatchesVersion = version;
+            filterMatchesStale = false;
+        }
+    }
 };
 
 
@@ -213,7 +263,7 @@ private:
     CurrentCueInfoVector &cciVector;
 
     CurrentCueInfo _blankCCI{};
-    std::string lastRenderedCCIInternalID;
+    CueHandle lastRenderedCCIHandle;
 
     float targetFontSize;
     Font oscArgumentValueFont = FontOptions();
@@ -253,10 +303,10 @@ public:
 
     void commandOccurred(ShowCommand) override;
 
-    void cueCommandOccurred(ShowCommand, std::string cciInternalID, size_t cciCurrentIndex) override;
+    void cueCommandOccurred(ShowCommand, CueHandle cciHandle, size_t cciCurrentIndex) override;
 
 private:
-    std::string lastCCIInternalID = ""; // Used to determine if the CCI has changed, so we can reconstruct the image
+    CueHandle lastCCIHandle; // Used to determine if the CCI has changed, so we can reconstruct the image
 
     ActiveShowOptions &activeShowOptions;
     CurrentCueInfoVector &cciVector;
@@ -365,7 +415,7 @@ public:
     // Used to listen for when command occurs. Part of inherited ShowCommandListener
     void commandOccurred(ShowCommand command) override;
     // Used to listen specifically for JUMP_TO_CUE actions.
-    void cueCommandOccurred(ShowCommand, std::string cciInternalID, size_t cciCurrentIndex) override;
+    void cueCommandOccurred(ShowCommand, CueHandle cciHandle, size_t cciCurrentIndex) override;
 
     // Button Listener for all DrawableButton objects
     void buttonClicked(Button *btn) override {
@@ -466,6 +516,36 @@ private:
 //==============================================================================
 
 
+/* Imports a JSON show (see ShowJSON) on a background thread behind a progress window, so a large show doesn't block
+ * the message thread while it's read. onFinished is called on the message thread once the read is done, with the cues
+ * read so far if it failed.
+ */
+class ShowImportWindow: public ThreadWithProgressWindow {
+public:
+    using FinishedCallback = std::function<void(const Result &result, std::vector<CurrentCueInfo> &&loadedCCIs,
+                                                const String &showName, const String &showDescription)>;
+
+    ShowImportWindow(const File &file, FinishedCallback onFinished);
+
+    void run() override;
+
+    void threadComplete(bool userPressedCancel) override;
+
+private:
+    const File file;
+    const FinishedCallback onFinished;
+    Result result{Result::ok()};
+    std::vector<CurrentCueInfo> loadedCCIs;
+    String showName;
+    String showDescription;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ShowImportWindow)
+};
+
+
+//==============================================================================
+
+
 class MainComponent : public Component, public ShowCommandListener, public OSCDispatcherListener, public OSCDeviceSelectorWindow::CloseListener,
     public ParentWindowListener, public KeyListener {
 public:
@@ -473,6 +553,7 @@ public:
     MainComponent();
 
     ~MainComponent() override {
+        autosave.discard(); // Closing cleanly, so there's nothing to recover next time
         terminateChildWindows();
         dispatcher.stopThread(5000);
         headerBar.unregisterListener(this);
@@ -499,18 +580,24 @@ public:
 
 
     // Implemented to listen for individual-cue ShowCommands
-    void cueCommandOccurred(ShowCommand, std::string cciInternalID, size_t cciCurrentIndex) override;
+    void cueCommandOccurred(ShowCommand, CueHandle cciHandle, size_t cciCurrentIndex) override;
     // Broadcasts cue commands to registered callbacks
-    void sendCueCommandToAllListeners(ShowCommand, const std::string &cciInternalID, size_t cciCurrentIndex) const;
+    void sendCueCommandToAllListeners(ShowCommand, CueHandle cciHandle, size_t cciCurrentIndex) const;
+
+    // Implemented to reconcile ActiveShowOptions once after a bulk edit of cciVector, then broadcast a single command.
+    void cuesEdited(const CueEditSummary&) override;
 
     // Set the correct index for the new CCI. Useful for when cue is moved.
     void setNewIndexForCCI() {
-        activeShowOptions.currentCueIndex = cciVector.getIndexByCCIInternalID(activeShowOptions.currentCueInternalID);
+        activeShowOptions.currentCueIndex = cciVector.getIndexByCCIHandle(activeShowOptions.currentCueHandle);
     }
 
-    // Receives callbacks from the OSCDispatcherManager when an individual action is finished.
-    // Callbacks to cueCommandOccurred when an entire CCI's actions is completed.
-    void actionFinished(std::string) override;
+    // Receives callbacks from the OSCDispatcherManager (on its thread) when an individual action is finished.
+    // Posts cueFinished() to the message thread when an entire CCI's actions is completed.
+    void actionFinished(ActionHandle) override;
+
+    // Callbacks to cueCommandOccurred for a CCI whose actions have all completed. Message thread only.
+    void cueFinished(CueHandle cciHandle);
 
     // Receives callbacks when a child window needs to close.
     void closeRequested(WindowType windowType, std::string uuid) override;
@@ -520,10 +607,40 @@ public:
 
     bool keyPressed(const KeyPress &key, Component *originatingComponent) override;;
 
+    // Saves the show as a show file (see ShowFile), or as JSON (see ShowJSON) when file has a .json extension. Shows
+    // an alert and returns false on failure.
+    bool saveShow(const File &file);
+
+    // Replaces every cue and the show's name and description, stopping everything that's running.
+    void replaceShow(std::vector<CurrentCueInfo> newCCIs, const String &showName, const String &showDescription);
+
+    // Replaces the show with the one saved in file (either format), stopping everything that's running. Shows an
+    // alert and returns false on failure, leaving the current show as it was. A JSON show is imported in the
+    // background (see ShowImportWindow), so for those this only returns false if an import is already running.
+    bool loadShow(const File &file);
+
+    // Replaces the show with a loaded one, or alerts the user and frees the cues if loading failed.
+    void finishLoadingShow(const Result &result, std::vector<CurrentCueInfo> &&loadedCCIs, const String &showName,
+                           const String &showDescription);
+
+    // Checks every action in the show against its template (see ShowValidator), and lists any problems for the user
+    // in a window titled title. Only warns: the show can still be run as it is.
+    void checkShow(const String &title);
+
+    // Applies the filter box's text to the cue list, scrolling to the first match. Called on every keystroke.
+    void filterCueList();
+
+    // Sends the console every address's value as it stands just before the current cue (see CueStateTracker), so a
+    // show jumped into part way through picks up from where it would have been. Sent by the dispatcher, which first
+    // cancels any fade still running on those addresses.
+    void restoreTrackedState();
+
 private:
     std::unique_ptr<OSCDeviceSelectorWindow> oscDevSelWin;
 
     std::unordered_map<std::string, std::unique_ptr<OSCCCIConstructor>> cciConstructorWindows;
+    std::unique_ptr<FileChooser> showFileChooser; // Kept alive while its (async) dialog is open
+    std::unique_ptr<ShowImportWindow> showImport; // The last JSON import. Stops its thread if still running when reset.
     Image backgroundPrerender;
     //==============================================================================
     // Your private member variables go here...
@@ -720,12 +837,22 @@ private:
     DraggableListBox cueListBox;
     CueListModel cueListModel;
     CueListData cueListData{cciVector, activeShowOptions};
+    TextEditor cueFilterBox{"cueFilterBox"};
 
     const std::vector<ShowCommandListener *> callbackCompsUponActiveShowOptionsChanged = {&headerBar, &sidePanel};
-    const std::vector<Component *> activeComps = {&headerBar, &sidePanel, &cueListBox};
+    const std::vector<Component *> activeComps = {&headerBar, &sidePanel, &cueListBox, &cueFilterBox};
 
     OSCDeviceSender oscDeviceSender;
     OSCCueDispatcherManager dispatcher{oscDeviceSender};
 
+    const File autosaveDirectory = File::getSpecialLocation(File::userApplicationDataDirectory)
+                                       .getChildFile("XM32CE").getChildFile("Autosave");
+    AutosaveJournal autosave{autosaveDirectory, cciVector, activeShowOptions};
+    // Preferences kept between runs. Saved as soon as they change.
+    PropertiesFile settings{File::getSpecialLocation(File::userApplicationDataDirectory)
+                                .getChildFile("XM32CE").getChildFile("Settings.xml"), PropertiesFile::Options()};
+    static constexpr const char *bundleCommandsSetting = "bundleCommands";
+    CueStateTracker stateTracker{cciVector};
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
@@ -92,12 +92,12 @@ std::vector<OSCArgument> OSCDeviceSender::compileOSCArguments(
         if (auto *optVal = std::get_if<OptionParam>(&args[i])) {
             // If it's an OptionParam, the value from the ValueStorer will be the string.
             // Do a quick check that the stringValue is a valid option
-            if (std::find(optVal->value.begin(), optVal->value.end(), argVals[i].stringValue)
+            if (std::find(optVal->value.begin(), optVal->value.end(), argVals[i].stringValue.toStdString())
                 == optVal->value.end()) {
                 jassertfalse; // Value not found in the options
                 return {};
             }
-            oscArguments.emplace_back(String(argVals[i].stringValue));
+            oscArguments.emplace_back(String(argVals[i].stringValue.toStdString()));
         } else if (auto *enumVal = std::get_if<EnumParam>(&args[i])) {
             if (enumVal->value.size() < argVals[i].intValue) {
                 jassertfalse; // Enum value out of range
@@ -138,7 +138,7 @@ std::vector<OSCArgument> OSCDeviceSender::compileOSCArguments(
                         argVals[i].stringValue.length() > nonIter->intMax) {
                         jassertfalse; // String value out of size range
                     }
-                    oscArguments.emplace_back(argVals[i].stringValue);
+                    oscArguments.emplace_back(argVals[i].stringValue.toStdString());
                     break;
                 }
                 case BITSET: {
@@ -147,7 +147,7 @@ std::vector<OSCArgument> OSCDeviceSender::compileOSCArguments(
                         jassertfalse; // Bitset value is not expected size
                     }
                     // Convert string to bitset, then to int
-                    oscArguments.emplace_back(std::stoi(argVals[i].stringValue, nullptr, 2));
+                    oscArguments.emplace_back(std::stoi(argVals[i].stringValue.toStdString(), nullptr, 2));
                     break;
                 }
                 default:
@@ -181,12 +181,12 @@ String OSCDeviceSender::fillInArgumentsOfEmbeddedPath(const ArgumentEmbeddedPath
             if (argIndx < pthArgVal.size()) {
                 // If it's an OptionParam, the value from the ValueStorer will be the string.
                 // Do a quick check that the stringValue is a valid option
-                if (std::find(optVal->value.begin(), optVal->value.end(), pthArgVal[argIndx].stringValue)
+                if (std::find(optVal->value.begin(), optVal->value.end(), pthArgVal[argIndx].stringValue.toStdString())
                     == optVal->value.end()) {
                     // Value not found in the options
                     jassertfalse; // Invalid option value provided for the path
                 }
-                finalString += String(pthArgVal[argIndx].stringValue);
+                finalString += String(pthArgVal[argIndx].stringValue.toStdString());
                 ++argIndx;
             } else
                 jassertfalse; // Not enough path arguments provided for the path
@@ -228,7 +228,7 @@ String OSCDeviceSender::fillInArgumentsOfEmbeddedPath(const ArgumentEmbeddedPath
                         jassertfalse; // String value out of size range
                         break;
                     }
-                    finalString += String(pthArgVal[argIndx].stringValue);
+                    finalString += String(pthArgVal[argIndx].stringValue.toStdString());
                     break;
                 }
                 // Bitset support for in-path arguments have been deprecated.
@@ -242,7 +242,7 @@ String OSCDeviceSender::fillInArgumentsOfEmbeddedPath(const ArgumentEmbeddedPath
                         break;
                     }
                     // Append the bitset to the finalString
-                    finalString += String(pthArgVal[argIndx].stringValue);
+                    finalString += String(pthArgVal[argIndx].stringValue.toStdString());
                     break;
                 }*/
                 default:
@@ -263,269 +263,710 @@ String OSCDeviceSender::fillInArgumentsOfEmbeddedPath(const ArgumentEmbeddedPath
     return finalString;
 }
 
+OSCBundlePacker::OSCBundlePacker(OSCDeviceSender &oscDevice, size_t maxBundleBytes): oscSender(oscDevice),
+    maxBundleBytes(maxBundleBytes) {
+    bundle.reserve(maxBundleBytes);
+}
+
+
+void OSCBundlePacker::add(const void *packet, size_t packetSize) {
+    // "#bundle" (padded to 8 bytes) followed by the timetag. A timetag of 1 means "immediately".
+    static constexpr char bundleHeader[16] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+    const size_t elementSize = 4 + packetSize;
+    if (sizeof(bundleHeader) + elementSize > maxBundleBytes) {
+        // Would never fit in a bundle, so just send it on its own
+        flush();
+        oscSender.sendRaw(packet, packetSize);
+        return;
+    }
+    if (bundle.size() + elementSize > maxBundleBytes) {
+        flush();
+    }
+    if (bundle.empty()) {
+        bundle.insert(bundle.end(), std::begin(bundleHeader), std::end(bundleHeader));
+    }
+
+    const auto size = ByteOrder::swapIfLittleEndian(static_cast<uint32>(packetSize));
+    const auto *sizeBytes = reinterpret_cast<const char *>(&size);
+    bundle.insert(bundle.end(), sizeBytes, sizeBytes + 4);
+    if (elementsInBundle == 0) {
+        firstElementOffset = bundle.size();
+    }
+    const auto *packetBytes = static_cast<const char *>(packet);
+    bundle.insert(bundle.end(), packetBytes, packetBytes + packetSize);
+    ++elementsInBundle;
+}
+
+
+void OSCBundlePacker::flush() {
+    if (elementsInBundle == 1) {
+        oscSender.sendRaw(bundle.data() + firstElementOffset, bundle.size() - firstElementOffset);
+    } else if (elementsInBundle > 1) {
+        oscSender.sendRaw(bundle.data(), bundle.size());
+    }
+    bundle.clear();
+    elementsInBundle = 0;
+}
+
+
 // Sends actual message. For performance’s sake, no checks are done here, so ensure the message is valid before calling this function.
 ThreadPoolJob::JobStatus OSCSingleActionDispatcher::runJob() {
+    if (cueAction.dispatchEpoch.isCancelled()) {
+        return jobHasFinished; // Stopped while waiting in the pool
+    }
     if (cueAction.oat == OAT_COMMAND) {
-        OSCMessage msg{cueAction.oscAddress};
-        if (std::get_if<OptionParam>(&cueAction.oatCommandOSCArgumentTemplate)) {
-            // If it's an OptionParam, the value from the ValueStorer will be the string.
-            msg.addString(cueAction.argument.stringValue);
-        } else if (std::get_if<EnumParam>(&cueAction.oatCommandOSCArgumentTemplate)) {
-            // As this is not a OPTIONS, we only need the index of the ENUM as the value.
-            msg.addInt32(cueAction.argument.intValue);
-        } else if (auto *nonIter = std::get_if<NonIter>(&cueAction.oatCommandOSCArgumentTemplate)) {
-            // Let's first determine if the value is int, float, string or bitset
-            // The NonIter will indicate the type (_meta_PARAMTYPE)
-            switch (nonIter->_meta_PARAMTYPE) {
-                case INT: {
-                    // Don't try "lin-f" it. Let it be.
-                    msg.addInt32(cueAction.argument.intValue);
-                    break;
-                }
-                case LINF:
-                case LOGF:
-                case LEVEL_161:
-                case LEVEL_1024: {
-                    // Adjust to normalised range (0.f-1.f)
-                    if (nonIter->normalisedInverted) {
-                        msg.addFloat32(1 - inferPercentageFromMinMaxAndValue(nonIter->floatMin, nonIter->floatMax, cueAction.argument.floatValue, nonIter->_meta_PARAMTYPE));
-                    } else {
-                        msg.addFloat32(inferPercentageFromMinMaxAndValue(nonIter->floatMin, nonIter->floatMax, cueAction.argument.floatValue, nonIter->_meta_PARAMTYPE));
-                    }
-                    break;
-                }
-                case STRING: {
-                    msg.addString(cueAction.argument.stringValue);
-                    break;
-                }
-                case BITSET: {
-                    msg.addInt32(std::stoi(cueAction.argument.stringValue, nullptr, 2));
-                    break;
-                }
-                default:
-                    jassertfalse;
-                    // Unsupported ParamType for NonIter Parameter Template. Is it a template ValueStorer (i.e., ParamType blank?)
-            }
-
+        if (cueAction.compiledPacket) {
+            oscSender.sendRaw(*cueAction.compiledPacket);
         } else {
-            jassertfalse; // Invalid OSCMessageArguments type in the action
+            auto msg = cueAction.buildCommandMessage();
+            oscSender.send(msg);
         }
-        oscSender.send(msg);
     } else if (cueAction.oat == OAT_FADE) {
-        // This is where it gets exponentially more complicated exponentially fast.
-        // For OAT_FADE, we need to construct a message with the fade time and the start and end values.
-        // We will have to manually construct the message, as the fade time is not integrated into most OSC devices.
-
-        // Fortunately, OSC Cue Actions only support NonIter types, so we are using oscArgumentTemplate.
-        // We'll have to normalised startValue and endValue to the range of the NonIter type.
-
-        double normalisedPercentage{0.0};
-        double normalisedEndPercentage{0.0};
-        int totalIncrements = static_cast<int>(std::ceil(cueAction.fadeTime * 1000 / FMMID));
-        // Total increments based on fade time and minimum iteration duration
-
-
-        // First, we have to find the correct normalised start and end values based on the oscArgumentTemplate.
-        if (cueAction.oscArgumentTemplate._meta_PARAMTYPE == INT) {
-            // Also assumes LINEAR
-            // Normalise the start and end values to the range of the NonIter type
-            normalisedPercentage = inferPercentageFromMinMaxAndValue(
-                cueAction.oscArgumentTemplate.intMin, cueAction.oscArgumentTemplate.intMax,
-                cueAction.startValue.intValue, LINF);
-            normalisedEndPercentage = inferPercentageFromMinMaxAndValue(cueAction.oscArgumentTemplate.intMin,
-                                                                        cueAction.oscArgumentTemplate.intMax,
-                                                                        cueAction.endValue.intValue, LINF);
-        } else if (cueAction.oscArgumentTemplate._meta_PARAMTYPE == LINF ||
-                   cueAction.oscArgumentTemplate._meta_PARAMTYPE == LOGF ||
-                   cueAction.oscArgumentTemplate._meta_PARAMTYPE == LEVEL_161 ||
-                   cueAction.oscArgumentTemplate._meta_PARAMTYPE == LEVEL_1024) {
-            normalisedPercentage = inferPercentageFromMinMaxAndValue(
-                cueAction.oscArgumentTemplate.floatMin, cueAction.oscArgumentTemplate.floatMax,
-                cueAction.startValue.floatValue, cueAction.oscArgumentTemplate._meta_PARAMTYPE);
-            normalisedEndPercentage = inferPercentageFromMinMaxAndValue(
-                cueAction.oscArgumentTemplate.floatMin, cueAction.oscArgumentTemplate.floatMax,
-                cueAction.endValue.floatValue, cueAction.oscArgumentTemplate._meta_PARAMTYPE);
-            if (cueAction.oscArgumentTemplate.normalisedInverted) {
-                normalisedPercentage = 1 - normalisedPercentage;
-                normalisedEndPercentage = 1 - normalisedEndPercentage;
-            }
-        } else {
-            jassertfalse; // Unsupported ParamType for NonIter Parameter Template in OAT_FADE
-            return JobStatus::jobHasFinished; // Exit the job if the ParamType is unsupported
+        jassertfalse; // OAT_FADE actions are run by the OSCFadeEngine, not by a pool job
+        return jobHasFinished;
+    } else {
+        jassertfalse; // Unsupported OSC Action Type
+        return jobHasFinished; // Exit the job if the OSC Action Type is unsupported
+    }
+    return jobHasFinished; // Indicate that the job has finished successfully
+}
+
+
+OSCFadeEngine::OSCFadeEngine(OSCDeviceSender &oscDevice, ActionCompletionSink &completionSink,
+                             int oatFadeMillisecondsMinimumIterationDuration, int quantisedFadeMinimumStepMs):
+    Thread("oscFadeEngine"), FMMID(oatFadeMillisecondsMinimumIterationDuration),
+    quantisedFadeMinimumStep(quantisedFadeMinimumStepMs), oscSender(oscDevice), completionSink(completionSink),
+    stepBundle(oscDevice) {
+    if (oatFadeMillisecondsMinimumIterationDuration <= 0) {
+        jassertfalse; // Minimum iteration duration must be above 0ms
+    }
+    addListener(this);
+}
+
+
+bool OSCFadeEngine::startFade(const CueOSCAction &cueAction) {
+    if (cueAction.oat != OAT_FADE) {
+        jassertfalse; // Only OAT_FADE actions can be run by the OSCFadeEngine
+        return false;
+    }
+    if (cueAction.dispatchEpoch.isCancelled()) {
+        return false; // Stopped while queued
+    }
+    auto fade = std::make_unique<ActiveFade>(cueAction);
+    if (!prepareFade(*fade)) {
+        return false;
+    }
+    // The first step is sent straight away, as it was when each fade had its own job
+    fade->fadeStart = std::chrono::steady_clock::now();
+    fade->nextStepDue = fade->fadeStart;
+
+    std::lock_guard<std::mutex> lock(fadeMutex);
+    // If the same action is started again while still fading, the old fade is superseded and never reported
+    if (const auto existing = actionToFadeSlot.find(cueAction.handle); existing != actionToFadeSlot.end()) {
+        const auto oldSlot = existing->second;
+        actionToFadeSlot.erase(existing);
+        cancelSlot(oldSlot);
+    }
+    // Take over from any other fade on the same address, continuing from where it has got to
+    if (const auto existing = findFadeSlotOnAddress(cueAction.oscAddress); existing != noFadeSlot) {
+        auto &oldFade = *fades[existing];
+        cancelSlot(existing);
+        if (oldFade.lastSentQuantum >= 0 || oldFade.incrementsSent > 0) {
+            fade->normalisedStartPercentage = oldFade.normalisedPercentage;
+            fade->normalisedPercentage = oldFade.normalisedPercentage;
+            fade->normalisedPercentageIncrement =
+                    (fade->normalisedEndPercentage - fade->normalisedPercentage) / fade->totalIncrements;
         }
+    }
 
+    size_t slot;
+    if (freeSlots.empty()) {
+        slot = fades.size();
+        fades.push_back(nullptr);
+    } else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    dueHeap.emplace_back(fade->nextStepDue, slot);
+    std::push_heap(dueHeap.begin(), dueHeap.end(), std::greater<>());
+    fades[slot] = std::move(fade);
+    actionToFadeSlot[cueAction.handle] = slot;
+    if (cueAction.oscAddress.getID() >= addressToFadeSlot.size()) {
+        addressToFadeSlot.resize(oscAddressPool.size(), noFadeSlot);
+    }
+    addressToFadeSlot[cueAction.oscAddress.getID()] = slot;
+    ++activeFadeCount;
+    fadeCondition.notify_all();
+    return true;
+}
 
-        // Manually convert min and max values to double - the type inferValueFromMinMaxAndPercentage accepts to prevent
-        // type conversion with every call
-        const double minVal = cueAction.oscArgumentTemplate._meta_PARAMTYPE == INT
-                                  ? cueAction.oscArgumentTemplate.intMin
-                                  : cueAction.oscArgumentTemplate.floatMin;
-        const double maxVal = cueAction.oscArgumentTemplate._meta_PARAMTYPE == INT
-                                  ? cueAction.oscArgumentTemplate.intMax
-                                  : cueAction.oscArgumentTemplate.floatMax;
 
+bool OSCFadeEngine::cancelFade(ActionHandle actionHandle) {
+    std::lock_guard<std::mutex> lock(fadeMutex);
+    const auto found = actionToFadeSlot.find(actionHandle);
+    if (found == actionToFadeSlot.end()) {
+        return false;
+    }
+    cancelSlot(found->second);
+    return true;
+}
 
-        // Now we have set how much each increment should be.
-        double normalisedPercentageIncrement = (normalisedEndPercentage - normalisedPercentage) / totalIncrements;
 
-        // Now for each increment, we will construct the message and send it.
-        for (int i = 0; (i < totalIncrements && !shouldExit()); ++i) {
-            auto messageStart = std::chrono::high_resolution_clock::now();
+bool OSCFadeEngine::cancelFadeOnAddress(const InternedOSCAddress &oscAddress) {
+    if (activeFadeCount.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(fadeMutex);
+    const auto found = findFadeSlotOnAddress(oscAddress);
+    if (found == noFadeSlot) {
+        return false;
+    }
+    cancelSlot(found);
+    return true;
+}
 
-            // Construct the message for each increment
-            OSCMessage incrementedMsg{cueAction.oscAddress};
-            normalisedPercentage += normalisedPercentageIncrement; // Increment the normalised start value
 
-            // The argument will have to be un-normalised to the original type.
-            switch (cueAction.oscArgumentTemplate._meta_PARAMTYPE) {
-                case INT:
-                    incrementedMsg.addInt32(static_cast<int>(inferValueFromMinMaxAndPercentage(
-                        minVal, maxVal, normalisedPercentage, LINF)));
-                    break;
-                default:
-                    incrementedMsg.addFloat32(normalisedPercentage);
-                    break;
-            }
+void OSCFadeEngine::cancelSlot(size_t slot) {
+    fades[slot]->cancelled = true;
+    finishSlot(slot);
+}
 
-            // Send the message
-            oscSender.send(incrementedMsg);
+void OSCFadeEngine::cancelAllFades() {
+    std::lock_guard<std::mutex> lock(fadeMutex);
+    for (size_t slot = 0; slot < fades.size(); ++slot) {
+        if (fades[slot]) { cancelSlot(slot); }
+    }
+}
 
 
-            std::chrono::duration<double, std::milli> elapsed =
-                    std::chrono::high_resolution_clock::now() - messageStart;
+void OSCFadeEngine::cancelFadesWithStaleEpochs() {
+    for (size_t slot = 0; slot < fades.size(); ++slot) {
+        if (fades[slot] && !fades[slot]->finished && fades[slot]->cueAction.dispatchEpoch.isCancelled()) {
+            cancelSlot(slot);
+        }
+    }
+}
 
-            // Check if minimum iteration duration has passed
-            if (elapsed.count() < FMMID) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(FMMID) - elapsed);
-            } else {
-                DBG("Warning: OAT_FADE iteration took longer than minimum duration. Consider increasing FMMID.");
-            }
+void OSCFadeEngine::run() {
+    std::unique_lock<std::mutex> lock(fadeMutex);
+    while (!threadShouldExit()) {
+        if (const auto generation = epochGeneration.load(std::memory_order_acquire);
+            generation != lastCheckedEpochGeneration) {
+            lastCheckedEpochGeneration = generation;
+            cancelFadesWithStaleEpochs();
         }
 
-        // If exited because of shouldExit(), we will not send the end message.
-        if (shouldExit()) {
-            return jobHasFinished; // Exit the job if the thread should exit
+        if (dueHeap.empty()) {
+            fadeCondition.wait(lock, [this] { return !dueHeap.empty() || threadShouldExit(); });
+            continue;
         }
 
-        // Finally, we need to send the end value to ensure the fade is complete... but to be safe, let's check if the
-        // normalisedPercentage is not already at the end value.
-        if (normalisedPercentage < normalisedEndPercentage) {
-            OSCMessage endMsg{cueAction.oscAddress};
-            switch (cueAction.oscArgumentTemplate._meta_PARAMTYPE) {
-                case INT:
-                    endMsg.addInt32(static_cast<int>(inferValueFromMinMaxAndPercentage(
-                        minVal, maxVal, normalisedPercentage, LINF)));
-                    break;
-                default:
-                    endMsg.addFloat32(normalisedPercentage);
-                    break;
+        // Sleep until the earliest step, but never longer than a tick, so a bumped epoch is always seen within one
+        // tick even if epochsChanged()'s notify was missed. Loop back afterwards, as a new fade may have been added
+        // with an earlier step.
+        const auto now = std::chrono::steady_clock::now();
+        if (dueHeap.front().first > now) {
+            fadeCondition.wait_until(lock, std::min(dueHeap.front().first, now + std::chrono::milliseconds(FMMID)));
+            continue;
+        }
+
+        // Advance every fade which is due now. Steps are only queued while the lock is held.
+        while (!dueHeap.empty() && dueHeap.front().first <= now && !threadShouldExit()) {
+            std::pop_heap(dueHeap.begin(), dueHeap.end(), std::greater<>());
+            const size_t slot = dueHeap.back().second;
+            dueHeap.pop_back();
+
+            auto &fade = *fades[slot];
+            if (fade.cancelled || fade.finished || advanceFade(fade, now)) {
+                retireFade(slot);
+                continue;
             }
-            oscSender.send(endMsg);
+            dueHeap.emplace_back(fade.nextStepDue, slot);
+            std::push_heap(dueHeap.begin(), dueHeap.end(), std::greater<>());
+        }
+        lock.unlock();
+        sendQueuedSteps();
+        lock.lock();
+
+        if (std::chrono::steady_clock::now() - now > std::chrono::milliseconds(FMMID)) {
+            DBG("Warning: OSCFadeEngine tick took longer than minimum duration. Consider increasing FMMID.");
+        }
+    }
+}
+
+bool OSCFadeEngine::prepareFade(ActiveFade &fade) const {
+    // OSC Cue Actions only support NonIter types for fades, so we are using getFadeTemplate().
+    // The start and end values are normalised to the range of the NonIter type.
+    const auto &argTemplate = fade.cueAction.getFadeTemplate();
+    if (argTemplate._meta_PARAMTYPE == INT) {
+        // Also assumes LINEAR
+        fade.normalisedPercentage = inferPercentageFromMinMaxAndValue(
+            argTemplate.intMin, argTemplate.intMax, fade.cueAction.startValue.intValue, LINF);
+        fade.normalisedEndPercentage = inferPercentageFromMinMaxAndValue(
+            argTemplate.intMin, argTemplate.intMax, fade.cueAction.endValue.intValue, LINF);
+    } else if (argTemplate._meta_PARAMTYPE == LINF ||
+               argTemplate._meta_PARAMTYPE == LOGF ||
+               argTemplate._meta_PARAMTYPE == LEVEL_161 ||
+               argTemplate._meta_PARAMTYPE == LEVEL_1024) {
+        fade.normalisedPercentage = inferPercentageFromMinMaxAndValue(
+            argTemplate.floatMin, argTemplate.floatMax, fade.cueAction.startValue.floatValue,
+            argTemplate._meta_PARAMTYPE);
+        fade.normalisedEndPercentage = inferPercentageFromMinMaxAndValue(
+            argTemplate.floatMin, argTemplate.floatMax, fade.cueAction.endValue.floatValue,
+            argTemplate._meta_PARAMTYPE);
+        if (argTemplate.normalisedInverted) {
+            fade.normalisedPercentage = 1 - fade.normalisedPercentage;
+            fade.normalisedEndPercentage = 1 - fade.normalisedEndPercentage;
         }
     } else {
-        jassertfalse; // Unsupported OSC Action Type
-        return jobHasFinished; // Exit the job if the OSC Action Type is unsupported
+        jassertfalse; // Unsupported ParamType for NonIter Parameter Template in OAT_FADE
+        return false;
     }
-    return jobHasFinished; // Indicate that the job has finished successfully
+
+    // Convert min and max values to double once - the type inferValueFromMinMaxAndPercentage accepts
+    fade.minVal = argTemplate._meta_PARAMTYPE == INT ? argTemplate.intMin : argTemplate.floatMin;
+    fade.maxVal = argTemplate._meta_PARAMTYPE == INT ? argTemplate.intMax : argTemplate.floatMax;
+
+    // Total increments based on fade time and minimum iteration duration. At least one, so a zero-length fade still
+    // sends its end value.
+    fade.totalIncrements = std::max(1, static_cast<int>(std::ceil(fade.cueAction.fadeTime * 1000 / FMMID)));
+    fade.normalisedStartPercentage = fade.normalisedPercentage;
+    fade.normalisedPercentageIncrement =
+            (fade.normalisedEndPercentage - fade.normalisedPercentage) / fade.totalIncrements;
+    fade.quantisationSteps = getNormalisedQuantisationSteps(argTemplate);
+    fade.fadeDurationMs = fade.cueAction.fadeTime * 1000.0;
+
+    // Serialise the message once with a placeholder argument. Each step then only overwrites the last 4 bytes.
+    OSCMessage stepTemplate{fade.cueAction.oscAddress.getPattern()};
+    if (argTemplate._meta_PARAMTYPE == INT) {
+        stepTemplate.addInt32(0);
+    } else {
+        stepTemplate.addFloat32(0.f);
+    }
+    fade.stepPacket = serialiseOSCMessage(stepTemplate, &fade.cueAction.oscAddress);
+    return true;
+}
+
+
+bool OSCFadeEngine::advanceFade(ActiveFade &fade, std::chrono::steady_clock::time_point now) {
+    const std::chrono::duration<double, std::milli> lateness = now - fade.nextStepDue;
+    fade.timing.addStepJitter(lateness.count());
+
+    if (fade.quantisationSteps > 0) {
+        return advanceQuantisedFade(fade, now);
+    }
+
+    // If we're late by more than a step, jump straight to the step that should be sending now. Sending the missed
+    // values late would only make the fade lag further behind.
+    const auto sinceStart = std::chrono::duration_cast<std::chrono::milliseconds>(now - fade.fadeStart).count();
+    const int stepDueNow = std::min(fade.totalIncrements, static_cast<int>(sinceStart / FMMID));
+    if (stepDueNow == 0 && fade.incrementsSent == 0 && fade.fadeDurationMs > 0.0) {
+        // Step 0: the start value, sent as soon as the fade starts
+        sendFadeValue(fade, fade.normalisedPercentage);
+        fade.nextStepDue = fade.fadeStart + std::chrono::milliseconds(FMMID);
+        return false;
+    }
+    const int step = std::max(fade.incrementsSent + 1, stepDueNow);
+    fade.timing.stepsSkipped += step - fade.incrementsSent - 1;
+    fade.incrementsSent = step;
+
+    if (fade.incrementsSent < fade.totalIncrements) {
+        // Computed from the start value rather than accumulated, so rounding never builds up over a long fade
+        fade.normalisedPercentage = fade.normalisedStartPercentage + fade.normalisedPercentageIncrement * step;
+        sendFadeValue(fade, fade.normalisedPercentage);
+        fade.nextStepDue = fade.fadeStart + std::chrono::milliseconds(FMMID) * (fade.incrementsSent + 1);
+        return false;
+    }
+
+    finishFade(fade);
+    return true;
+}
+
+
+bool OSCFadeEngine::advanceQuantisedFade(ActiveFade &fade, std::chrono::steady_clock::time_point now) {
+    const std::chrono::duration<double, std::milli> sinceStart = now - fade.fadeStart;
+    if (sinceStart.count() >= fade.fadeDurationMs) {
+        finishFade(fade);
+        return true;
+    }
+
+    // Where the fade should be right now, and the step of the console's grid that lands on
+    const double range = fade.normalisedEndPercentage - fade.normalisedStartPercentage;
+    const double steps = fade.quantisationSteps;
+    const bool descending = range < 0.0;
+    const double percentageNow = fade.normalisedStartPercentage + range * sinceStart.count() / fade.fadeDurationMs;
+    const int quantum = getQuantum(percentageNow, fade.quantisationSteps, descending);
+
+    if (quantum != fade.lastSentQuantum) {
+        if (fade.lastSentQuantum >= 0) {
+            fade.timing.stepsSkipped += std::abs(quantum - fade.lastSentQuantum) - 1;
+        }
+        fade.lastSentQuantum = quantum;
+        ++fade.incrementsSent;
+        // Send the grid value itself, so the console gets exactly the value it would round to anyway
+        fade.normalisedPercentage = quantum / steps;
+        sendFadeValue(fade, fade.normalisedPercentage);
+    }
+
+    // Schedule the next step for when the fade crosses into the next quantum (i.e., the halfway point between the
+    // current grid value and the next), but no sooner than the minimum step and no later than the end of the fade.
+    const auto fadeEnd = fade.fadeStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double, std::milli>(fade.fadeDurationMs));
+    auto nextStepDue = fadeEnd;
+    if (range != 0.0) {
+        nextStepDue = std::min(fadeEnd, fade.fadeStart + getTimeOfNextQuantum(quantum, fade.quantisationSteps,
+                                                                             fade.normalisedStartPercentage,
+                                                                             fade.normalisedEndPercentage,
+                                                                             fade.fadeDurationMs));
+    }
+    fade.nextStepDue = std::max(nextStepDue, now + quantisedFadeMinimumStep);
+    return false;
+}
+
+
+int OSCFadeEngine::getQuantum(double normalisedValue, int quantisationSteps, bool descending) {
+    // Halfway values are rounded towards where the fade is heading, so the step is sent on the boundary itself. The
+    // tolerance absorbs the rounding error of working out the value from the time, which can leave it just short.
+    constexpr double boundaryTolerance = 1e-9;
+    const double scaled = jlimit(0.0, 1.0, normalisedValue) * quantisationSteps;
+    return static_cast<int>(descending ? std::ceil(scaled - 0.5 - boundaryTolerance)
+                                       : std::floor(scaled + 0.5 + boundaryTolerance));
+}
+
+
+std::chrono::steady_clock::duration OSCFadeEngine::getTimeOfNextQuantum(int quantum, int quantisationSteps,
+                                                                        double normalisedStart,
+                                                                        double normalisedEnd, double fadeDurationMs) {
+    const double range = normalisedEnd - normalisedStart;
+    const double boundary = (quantum + (range < 0.0 ? -0.5 : 0.5)) / quantisationSteps;
+    const std::chrono::duration<double, std::milli> boundaryMs((boundary - normalisedStart) / range * fadeDurationMs);
+    // Rounded up, so the step is never due a moment before the fade has actually crossed the boundary
+    return std::chrono::ceil<std::chrono::steady_clock::duration>(boundaryMs);
 }
 
 
+void OSCFadeEngine::finishFade(ActiveFade &fade) {
+    // Last step. Send the exact end value.
+    fade.normalisedPercentage = fade.normalisedEndPercentage;
+    sendFadeValue(fade, fade.normalisedEndPercentage);
+
+    const auto fadeEnd = fade.fadeStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double>(fade.cueAction.fadeTime));
+    const std::chrono::duration<double, std::milli> overrun = std::chrono::steady_clock::now() - fadeEnd;
+    fade.timing.totalOverrunMs = overrun.count();
+}
+
+
+void OSCFadeEngine::sendFadeValue(ActiveFade &fade, double normalisedValue) {
+    // Accumulated increments can overshoot 0 or 1 by a rounding error
+    normalisedValue = jlimit(0.0, 1.0, normalisedValue);
+
+    // The argument will have to be un-normalised to the original type, then patched into the pre-serialised packet
+    // as big-endian. No allocation happens here.
+    uint32 argumentBits;
+    if (fade.cueAction.getFadeTemplate()._meta_PARAMTYPE == INT) {
+        const auto value = static_cast<int32>(std::round(inferValueFromMinMaxAndPercentage(
+            fade.minVal, fade.maxVal, normalisedValue, LINF)));
+        std::memcpy(&argumentBits, &value, sizeof(argumentBits));
+    } else {
+        const auto value = static_cast<float>(normalisedValue);
+        std::memcpy(&argumentBits, &value, sizeof(argumentBits));
+    }
+    argumentBits = ByteOrder::swapIfLittleEndian(argumentBits);
+    std::memcpy(static_cast<char *>(fade.stepPacket.getData()) + fade.stepPacket.getSize() - sizeof(argumentBits),
+                &argumentBits, sizeof(argumentBits));
+
+    // Copied, as the fade may be retired (and its packet freed) before the tick's steps are sent
+    const auto *packetBytes = static_cast<const char *>(fade.stepPacket.getData());
+    queuedStepBytes.insert(queuedStepBytes.end(), packetBytes, packetBytes + fade.stepPacket.getSize());
+    queuedStepEnds.push_back(queuedStepBytes.size());
+}
+
+
+void OSCFadeEngine::sendQueuedSteps() {
+    const bool bundle = bundleFadeSteps;
+    size_t stepBegin = 0;
+    for (const auto stepEnd: queuedStepEnds) {
+        if (bundle) {
+            stepBundle.add(queuedStepBytes.data() + stepBegin, stepEnd - stepBegin);
+        } else {
+            oscSender.sendRaw(queuedStepBytes.data() + stepBegin, stepEnd - stepBegin);
+        }
+        stepBegin = stepEnd;
+    }
+    stepBundle.flush();
+    // Cleared rather than freed, so a steady tick never allocates
+    queuedStepBytes.clear();
+    queuedStepEnds.clear();
+}
+
+
+void OSCFadeEngine::finishSlot(size_t slot) {
+    auto &fade = *fades[slot];
+    if (fade.finished) {
+        return;
+    }
+    fade.finished = true;
+    // Only report the fade if it has not been superseded by a newer fade of the same action
+    if (const auto found = actionToFadeSlot.find(fade.cueAction.handle);
+        found != actionToFadeSlot.end() && found->second == slot) {
+        completionSink.postCompletion({fade.cueAction.handle, fade.cancelled, true, fade.timing});
+        actionToFadeSlot.erase(found);
+    }
+    if (findFadeSlotOnAddress(fade.cueAction.oscAddress) == slot) {
+        addressToFadeSlot[fade.cueAction.oscAddress.getID()] = noFadeSlot;
+    }
+    --activeFadeCount;
+}
+
+
+void OSCFadeEngine::retireFade(size_t slot) {
+    finishSlot(slot);
+    fades[slot].reset();
+    freeSlots.push_back(slot);
+}
+
 OSCCueDispatcherManager::OSCCueDispatcherManager(OSCDeviceSender &oscDevice,
                                                  unsigned int maximumSimultaneousMessageThreads,
                                                  unsigned int waitMSFromWhenActionQueueIsEmpty): oscSender(oscDevice),
     maximumSimultaneousMessageThreads(maximumSimultaneousMessageThreads), Thread("oscCueDispatcherManager"),
-    waitMSFromWhenActionQueueIsEmpty(waitMSFromWhenActionQueueIsEmpty) {
+    waitMSFromWhenActionQueueIsEmpty(waitMSFromWhenActionQueueIsEmpty), fadeEngine(oscDevice, *this),
+    commandBundle(oscDevice) {
     if (maximumSimultaneousMessageThreads == 0 || maximumSimultaneousMessageThreads > 511) {
         jassertfalse; // Maximum simultaneous message threads must be above 1 and should be below 512.
     }
     addListener(this);
+    completedActions.reserve(512);
     // setPriority(Priority::high); // Set a higher priority for the thread to ensure it processes messages quickly
 };
 
 
 void OSCCueDispatcherManager::addCueToMessageQueue(const CurrentCueInfo &cueInfo) {
+    // Stamp every action with the cue's current epoch, so stopAllActionsInCCI can cancel them with one increment
+    auto &cueEpoch = cueEpochs[cueInfo.getHandle()];
+    if (!cueEpoch) {
+        cueEpoch = std::make_shared<std::atomic<uint64>>(0);
+    }
+    std::vector<CueOSCAction> stampedActions;
+    stampedActions.reserve(cueInfo.actions.size());
     for (const auto &action: cueInfo.actions) {
-        addCueToMessageQueue(action);
+        stampedActions.push_back(action);
+        stampedActions.back().dispatchEpoch = {cueEpoch, &globalEpoch, cueEpoch->load(), globalEpoch.load()};
     }
+
+    // Pushed as one batch, so run() always sees the whole cue at once and can bundle it. Never dropped: a cue bigger
+    // than the ring, or a GO while the queue is backed up, spills into the queue's overflow list.
+    actionQueue.pushBatch(std::make_move_iterator(stampedActions.begin()),
+                          std::make_move_iterator(stampedActions.end()));
 }
 
 
 void OSCCueDispatcherManager::addCueToMessageQueue(const CueOSCAction &cueAction) {
-    actionQueue.push(cueAction);
+    // Not part of a cue, so only stopAllActions can cancel it through its epoch
+    auto stampedAction = cueAction;
+    stampedAction.dispatchEpoch = {nullptr, &globalEpoch, 0, globalEpoch.load()};
+    actionQueue.push(std::move(stampedAction));
 }
 
 
 void OSCCueDispatcherManager::run() {
+    // Fades are timing-sensitive, so the engine gets realtime priority where the OS allows it
+    if (!fadeEngine.isThreadRunning() &&
+        !fadeEngine.startRealtimeThread(Thread::RealtimeOptions().withPriority(8))) {
+        fadeEngine.startThread(Priority::high);
+    }
+
     while (!threadShouldExit()) {
+        // Blocks until an action is pushed, so a GO is dispatched as soon as it arrives. Also returns early (with no
+        // action) when an executor posts a completion, so finished actions are reported straight away.
+        auto nextAction = actionQueue.popWait(std::chrono::milliseconds(waitMSFromWhenActionQueueIsEmpty));
+        sendQueuedPackets();
+        if (!nextAction) {
+            // Timed out, or woken by postCompletion
+            notifyCompletedActions();
+            continue;
+        }
 
-        while (actionQueue.empty()) {
-            auto waitStart = std::chrono::high_resolution_clock::now();
-            // Also check if a cue job has finished. This is a non-realtime operation, so we can shove it into this loop
-            // Create a copy of the actionIDToJobMap to avoid modifying the map while iterating
-            auto actionIDToJobMapCopy = actionIDToJobMap; // Copy the map to avoid modifying while iterating
-            for (const auto& [id, singleActionDispatcher]: actionIDToJobMapCopy) {
-                // Check if the singleActionDispatcher is in the pool (i.e., it has not been removed yet)
-                if (!singleActionDispatcherPool.contains(singleActionDispatcher)) {
-                    actionIDToJobMap.erase(id);
-                    // Notify listeners that the action has finished
-                    for (auto *listener: dispatchListeners) {
-                        listener->actionFinished(id);
-                    }
+        if (bundleCommands) {
+            // Every pre-compiled command already queued goes into the same bundle(s). Whole cues are pushed as one
+            // batch, so this always covers at least the whole cue.
+            while (nextAction && nextAction->oat == OAT_COMMAND && nextAction->compiledPacket) {
+                if (!nextAction->dispatchEpoch.isCancelled()) {
+                    fadeEngine.cancelFadeOnAddress(nextAction->oscAddress);
+                    commandBundle.add(*nextAction->compiledPacket);
+                }
+                completedActions.push_back(nextAction->handle);
+                nextAction.reset();
+                if (auto queuedAction = actionQueue.tryPop()) {
+                    nextAction.emplace(std::move(*queuedAction));
                 }
             }
-            std::chrono::duration<double, std::milli> elapsed =
-                    std::chrono::high_resolution_clock::now() - waitStart;
-            if (elapsed.count() < waitMSFromWhenActionQueueIsEmpty) {
-                // Sleep for the remaining time to wait
-                std::this_thread::sleep_for(
-                    std::chrono::milliseconds(waitMSFromWhenActionQueueIsEmpty) - elapsed);
-            } else {
-                DBG("Warning: OSC Cue Dispatcher Manager exceeded waitMSFromWhenActionQueueIsEmpty. This means each "
-                    "iteration checking if the queue is empty took longer than the allowed wait time. "
-                    "Consider increasing wait time or running the thread with realtime priority or more "
-                    "system resources.");
+            commandBundle.flush();
+            if (!nextAction) {
+                notifyCompletedActions();
+                continue;
             }
         }
 
-        auto action = actionQueue.front();
-        actionQueue.pop();
-        if (action.oat == EXIT_THREAD) {
+        if (!dispatchAction(*nextAction)) {
             return;
         }
-        auto *dispatcher = new OSCSingleActionDispatcher(action, oscSender);
-        singleActionDispatcherPool.addJob(dispatcher, true);
-        actionIDToJobMap[action.ID] = dispatcher;
+        // Reported after every batch (a bundle, or a single action), so a busy queue never holds completions back.
+        // Listeners only do real work once a cue's last action is reported, so this costs little.
+        notifyCompletedActions();
+    }
+}
+
+
+void OSCCueDispatcherManager::sendPackets(std::vector<AddressedPacket> packets) {
+    packetQueue.pushBatch(std::make_move_iterator(packets.begin()), std::make_move_iterator(packets.end()));
+    actionQueue.interruptWait();
+}
+
+
+void OSCCueDispatcherManager::sendQueuedPackets() {
+    bool bundled = false;
+    while (auto queued = packetQueue.tryPop()) {
+        fadeEngine.cancelFadeOnAddress(queued->address);
+        if (bundleCommands) {
+            commandBundle.add(*queued->packet);
+            bundled = true;
+        } else {
+            oscSender.sendRaw(*queued->packet);
+        }
+    }
+    if (bundled) {
+        commandBundle.flush();
+    }
+}
+
+
+void OSCCueDispatcherManager::postCompletion(ActionCompletion completion) {
+    completionQueue.push(std::move(completion));
+    actionQueue.interruptWait();
+}
+
+
+void OSCCueDispatcherManager::notifyCompletedActions() {
+    while (auto completion = completionQueue.tryPop()) {
+        if (completion->isFade) {
+            for (auto *listener: dispatchListeners) {
+                listener->fadeTimingMeasured(completion->action, completion->fadeTiming);
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(jobMapMutex);
+            actionToJobMap.erase(completion->action);
+        }
+        completedActions.push_back(completion->action);
+    }
+    if (completedActions.empty()) {
+        return;
+    }
+    for (auto *listener: dispatchListeners) {
+        listener->actionsFinished(completedActions);
+    }
+    completedActions.clear();
+}
+
 
+// Dispatches a single action. Returns false if the action was EXIT_THREAD.
+bool OSCCueDispatcherManager::dispatchAction(const CueOSCAction &action) {
+    if (action.oat == EXIT_THREAD) {
+        return false;
+    }
+    if (action.dispatchEpoch.isCancelled()) {
+        // Stopped while queued - never sent, but still reported so the cue stops showing as running
+        completedActions.push_back(action.handle);
+        return true;
+    }
+    if (action.oat == OAT_FADE) {
+        if (!fadeEngine.startFade(action)) {
+            // Invalid fade - nothing will run, so report it as finished straight away
+            completedActions.push_back(action.handle);
+        }
+        return true;
     }
+    if (action.oat == OAT_COMMAND) {
+        // A command overrides any fade still running on its address
+        fadeEngine.cancelFadeOnAddress(action.oscAddress);
+    }
+    if (action.oat == OAT_COMMAND && action.compiledPacket) {
+        // Already serialised, so there's nothing left to do but hand the bytes to the socket. Doing it here
+        // rather than in a pool job means a cue of many commands goes out in one tight loop.
+        oscSender.sendRaw(*action.compiledPacket);
+        completedActions.push_back(action.handle);
+        return true;
+    }
+    auto *dispatcher = new OSCSingleActionDispatcher(action, oscSender, *this);
+    {
+        // Added to the map before the pool, so the job's completion can never arrive before its entry
+        std::lock_guard<std::mutex> lock(jobMapMutex);
+        actionToJobMap[action.handle] = dispatcher;
+    }
+    singleActionDispatcherPool.addJob(dispatcher, true);
+    return true;
 }
 
 
-// Tries to stop the action with the given actionID. If the action is not found, it does nothing unless
+// Tries to stop the action with the given handle. If the action is not found, it does nothing unless
 // jassertWhenNotFound is true, in which case it asserts.
-void OSCCueDispatcherManager::stopAction(const std::string &actionID, bool jassertWhenNotFound) {
+void OSCCueDispatcherManager::stopAction(ActionHandle actionHandle, bool jassertWhenNotFound) {
     // Find the pointer if it exists
-    const auto job = actionIDToJobMap.find(actionID);
-    if (job == actionIDToJobMap.end()) {
+    std::unique_lock<std::mutex> lock(jobMapMutex);
+    const auto job = actionToJobMap.find(actionHandle);
+    if (job == actionToJobMap.end()) {
+        lock.unlock();
+        // Not a command job - it may be a fade
+        if (fadeEngine.cancelFade(actionHandle)) {
+            return;
+        }
         if (jassertWhenNotFound) { jassertfalse; }  // ID not found.
         return; // Action not found, nothing to stop
     }
-    // See if this works...
-    singleActionDispatcherPool.removeJob(job->second, true, 1000);
+    // The lock is held across removeJob. The job may already have finished and been deleted by the pool, but no new
+    // job can be added (at the same address) until the lock is released, so the pool won't match a different job.
+    // The job's destructor only pushes to completionQueue, so it never needs the lock.
+    // Doesn't wait: a job which hasn't started is deleted (and reported) straight away, and a running job sends a
+    // single message, so it is left to finish and report itself.
+    singleActionDispatcherPool.removeJob(job->second, true, 0);
 }
 
 
 void OSCCueDispatcherManager::stopAllActionsInCCI(const CurrentCueInfo &cueInfo, bool jassertWhenNotFound) {
-    for (const auto& action: cueInfo.actions) {
-        stopAction(action.ID, jassertWhenNotFound);
+    const auto cueEpoch = cueEpochs.find(cueInfo.getHandle());
+    if (cueEpoch == cueEpochs.end()) {
+        if (jassertWhenNotFound) { jassertfalse; } // Cue was never dispatched
+        return;
     }
+    // Queued actions of the cue are dropped by run() and running fades are cancelled on the engine's next tick
+    cueEpoch->second->fetch_add(1, std::memory_order_release);
+    // The actions keep the epoch alive, so the entry can go. The cue's next GO starts a new epoch.
+    cueEpochs.erase(cueEpoch);
+    fadeEngine.epochsChanged();
+}
+
+
+void OSCCueDispatcherManager::cueFinished(CueHandle cueHandle) {
+    cueEpochs.erase(cueHandle);
+}
+
+
+void OSCCueDispatcherManager::stopAllActions() {
+    globalEpoch.fetch_add(1, std::memory_order_release);
+    cueEpochs.clear(); // Every queued and running action is cancelled through globalEpoch
+    fadeEngine.epochsChanged();
 }
 
 
 bool OSCDeviceSender::connect() {
-    return oscSender.connect(ipAddress, port);
+    const SpinLock::ScopedLockType lock(socketLock);
+    // OSCSender writes through our socket rather than its own, so sendRaw's packets leave from the same port
+    return oscSender.connectToSocket(socket, ipAddress, port);
 }
 
 bool OSCDeviceSender::disconnect() {
+    const SpinLock::ScopedLockType lock(socketLock);
     return oscSender.disconnect();
 }
 
@@ -564,6 +1005,7 @@ void OSCDeviceSelectorComponent::initaliseComponents() {
     addAndMakeVisible(portTextEditor);
     addAndMakeVisible(deviceNameTextEditor);
     addAndMakeVisible(inputErrors);
+    addAndMakeVisible(bundleToggle);
 }
 
 
@@ -657,8 +1099,8 @@ void OSCDeviceSelectorComponent::resized() {
         deviceNameLabelBox.toNearestInt(), Justification::centredLeft, 1);
     deviceNameTextEditor.setBounds(deviceNameBox);
 
-    // 1/10 of the window height for padding
-    contentBounds.removeFromTop(heightTenth);
+    // 1/10 of the window height for the bundling toggle, which also pads the buttons from the inputs
+    bundleToggle.setBounds(contentBounds.removeFromTop(heightTenth));
 
     // Apply and Cancel buttons
     applyButton.setBounds(contentBounds.removeFromLeft(widthTenth * 2));
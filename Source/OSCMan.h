@@ -13,12 +13,17 @@
 #include "Helpers.h"
 #include "AppComponents.h"
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
 
 
 struct OSCDevice {
     String ipAddress;
     int port{};
     String deviceName;
+    bool bundleCommands{false}; // Send each cue's commands in OSC bundles. See OSCCueDispatcherManager::setBundlingEnabled
 
     OSCDevice(const String& ipAddress, int port, const String& deviceName): ipAddress(ipAddress), port(port), deviceName(deviceName) {}
     OSCDevice() {}
@@ -27,13 +32,47 @@ struct OSCDevice {
 
 
 
+// Timing of a fade's steps, measured against the absolute deadline of each step. Jitter is how late a step was sent.
+struct FadeTimingStats {
+    int stepsSent{0};
+    int stepsSkipped{0}; // Steps skipped to catch up after the engine was late
+    double minJitterMs{0.0};
+    double maxJitterMs{0.0};
+    double totalJitterMs{0.0};
+    double totalOverrunMs{0.0}; // How long after (start + fadeTime) the final value was sent. Negative if early.
+
+    double getMeanJitterMs() const { return stepsSent == 0 ? 0.0 : totalJitterMs / stepsSent; }
+
+    void addStepJitter(double jitterMs) {
+        if (stepsSent == 0 || jitterMs < minJitterMs) { minJitterMs = jitterMs; }
+        if (stepsSent == 0 || jitterMs > maxJitterMs) { maxJitterMs = jitterMs; }
+        totalJitterMs += jitterMs;
+        ++stepsSent;
+    }
+};
+
+
 class OSCDispatcherListener {
 public:
     virtual ~OSCDispatcherListener() = default;
 
     /* Called when event from OSCDispatchManager needs to be relayed to the caller.
     */
-    virtual void actionFinished(std::string) = 0;
+    virtual void actionFinished(ActionHandle) = 0;
+
+    /* Called with every action which has finished since the last call. Override to handle a batch at once - by
+     * default, calls actionFinished for each.
+    */
+    virtual void actionsFinished(const std::vector<ActionHandle> &actionHandles) {
+        for (const auto &actionHandle: actionHandles) {
+            actionFinished(actionHandle);
+        }
+    }
+
+    /* Called with the step timing of every fade which finished or was cancelled, just before it is reported by
+     * actionsFinished. Does nothing by default.
+    */
+    virtual void fadeTimingMeasured(ActionHandle, const FadeTimingStats &) {}
 };
 
 
@@ -89,10 +128,22 @@ public:
                                                         ValueStorerArray &argVals);
 
     void send(OSCMessage &message) {
+        const SpinLock::ScopedLockType lock(socketLock);
         oscSender.send(message);
     }
 
+    // Sends an already serialised OSC packet (see serialiseOSCMessage) straight to the socket, skipping OSCSender's
+    // per-message serialisation. Uses the same socket as send(), so the console sees one source port.
+    bool sendRaw(const void *packet, size_t packetSize) {
+        const SpinLock::ScopedLockType lock(socketLock); // Called from both the dispatcher and the fade engine
+        return socket.write(ipAddress, port, packet, static_cast<int>(packetSize)) > 0;
+    }
+
+    bool sendRaw(const MemoryBlock &packet) { return sendRaw(packet.getData(), packet.getSize()); }
+
 private:
+    DatagramSocket socket; // Every message goes out through this. Declared before oscSender, which writes to it.
+    SpinLock socketLock;
     OSCSender oscSender;
     // OSCMessage
     String ipAddress;
@@ -101,18 +152,61 @@ private:
 };
 
 
+/* Packs serialised OSC messages into OSC bundles with an immediate timetag, so a console receives (and applies) them
+ * together. A bundle is sent whenever the next message would take it past maxBundleBytes, and on flush(). A single
+ * message is sent on its own rather than wrapped in a bundle.
+ */
+class OSCBundlePacker {
+public:
+    // The default maxBundleBytes keeps each bundle within one Ethernet frame: 1500 byte MTU - 20 (IP) - 8 (UDP).
+    explicit OSCBundlePacker(OSCDeviceSender &oscDevice, size_t maxBundleBytes = 1472);
+
+    void add(const void *packet, size_t packetSize);
+
+    void add(const MemoryBlock &packet) { add(packet.getData(), packet.getSize()); }
+
+    // Sends whatever has been packed so far.
+    void flush();
+
+private:
+    OSCDeviceSender &oscSender;
+    const size_t maxBundleBytes;
+    std::vector<char> bundle;
+    size_t firstElementOffset{0}; // Where the first message is stored, so a lone message can be sent unbundled
+    int elementsInBundle{0};
+};
+
+
+// An action which has finished (or been cancelled), posted by whichever executor ran it
+struct ActionCompletion {
+    ActionHandle action;
+    bool cancelled{false};
+    bool isFade{false};
+    FadeTimingStats fadeTiming; // Only filled in for fades
+};
+
+
+// Receives completion events from the executors (pool jobs and the fade engine). Implemented by
+// OSCCueDispatcherManager. postCompletion must be safe to call from any thread.
+class ActionCompletionSink {
+public:
+    virtual ~ActionCompletionSink() = default;
+
+    virtual void postCompletion(ActionCompletion completion) = 0;
+};
+
+
 class OSCSingleActionDispatcher : public ThreadPoolJob {
 public:
-    /* Constructor for OSCSingleActionDispatcher.
+    /* Constructor for OSCSingleActionDispatcher. Only used for OAT_COMMAND actions - fades are run by OSCFadeEngine.
      * cueAction - The CueOSCAction to dispatch.
-     * oscDevice - The OSCDeviceSender to use for sending messages.free(): invalid size
+     * oscDevice - The OSCDeviceSender to use for sending messages.
+     * completionSink - Where the job reports that it has finished.
      * jobName - The name of the job, used for debugging and logging.
-     * oatFadeMillisecondsMinimumIterationDuration - The minimum duration for each iteration of the fade in milliseconds.
-     *  Basically acts like a frame limiter.
      */
-    OSCSingleActionDispatcher(CueOSCAction cueAction, OSCDeviceSender &oscDevice, const String &jobName = "",
-                              int oatFadeMillisecondsMinimumIterationDuration = 50): ThreadPoolJob(jobName),
-        oscSender(oscDevice), cueAction(cueAction), FMMID(oatFadeMillisecondsMinimumIterationDuration) {
+    OSCSingleActionDispatcher(CueOSCAction cueAction, OSCDeviceSender &oscDevice, ActionCompletionSink &completionSink,
+                              const String &jobName = ""):
+        ThreadPoolJob(jobName), oscSender(oscDevice), completionSink(completionSink), cueAction(cueAction) {
     }
 
     JobStatus runJob() override;
@@ -120,18 +214,181 @@ public:
     ~OSCSingleActionDispatcher() override {
         // Try end the job
         signalJobShouldExit();
+        // Posted from here rather than runJob, so a job removed from the pool before it ran is still reported
+        completionSink.postCompletion({cueAction.handle});
     };
 
 private:
-    const unsigned int FMMID; // The minimum duration passed before next increment for OAT_FADE actions (ms)
     CueOSCAction cueAction;
     OSCDeviceSender &oscSender; // The OSC Device Sender to use for sending messages
+    ActionCompletionSink &completionSink;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OSCSingleActionDispatcher)
 };
 
 
-class OSCCueDispatcherManager : public Thread, public Thread::Listener {
+// A single OAT_FADE being run by the OSCFadeEngine. All values are pre-computed when the fade is started, so each
+// step is only a multiply and a send.
+struct ActiveFade {
+    CueOSCAction cueAction;
+    double normalisedStartPercentage{0.0};
+    double normalisedPercentage{0.0}; // The last normalised value sent (or the start value if nothing sent yet)
+    double normalisedEndPercentage{0.0};
+    double normalisedPercentageIncrement{0.0};
+    double minVal{0.0}; // Min and max of the template as doubles, so we don't convert them on every step
+    double maxVal{0.0};
+    int totalIncrements{0};
+    int incrementsSent{0};
+    // When the console quantises the parameter (see getNormalisedQuantisationSteps), the fade is instead stepped from
+    // one quantised value to the next, at the moments the value actually changes. 0 when not quantised.
+    int quantisationSteps{0};
+    int lastSentQuantum{-1};
+    double fadeDurationMs{0.0};
+    // Step n is due at fadeStart + n * FMMID, with step 0 (the start value) sent straight away. Deadlines are always
+    // computed from fadeStart rather than from the previous step, so lateness never accumulates over a long fade.
+    std::chrono::steady_clock::time_point fadeStart;
+    std::chrono::steady_clock::time_point nextStepDue;
+    FadeTimingStats timing;
+    bool finished{false}; // Completion has been posted. The slot is freed when its heap entry next comes up.
+    MemoryBlock stepPacket; // The serialised step message. Only its last 4 bytes (the argument) change between steps.
+    bool cancelled{false}; // Set when the fade is stopped. Cancelled fades are skipped and removed on their next tick.
+
+    explicit ActiveFade(const CueOSCAction &cueAction): cueAction(cueAction) {}
+};
+
+
+/* Runs every OAT_FADE from one thread. Active fades are held in a min-heap ordered by when their next step is due,
+ * so the thread only ever sleeps until the earliest step and then advances every fade that is due at that moment.
+ * This replaces running one OSCSingleActionDispatcher (and hence one pool thread) per fade.
+ */
+class OSCFadeEngine : public Thread, public Thread::Listener {
+public:
+    /* oatFadeMillisecondsMinimumIterationDuration - Step interval for fades of continuous values.
+     * quantisedFadeMinimumStepMs - Shortest interval allowed between steps of a quantised fade. Quantised fades only
+     * send when the console's value changes, so they can step faster than continuous ones without sending more.
+     */
+    explicit OSCFadeEngine(OSCDeviceSender &oscDevice, ActionCompletionSink &completionSink,
+                           int oatFadeMillisecondsMinimumIterationDuration = 50, int quantisedFadeMinimumStepMs = 10);
+
+    ~OSCFadeEngine() override {
+        removeListener(this);
+        stopThread(1000);
+    }
+
+    void exitSignalSent() override {
+        // Wake the tick loop so it can see threadShouldExit()
+        std::lock_guard<std::mutex> lock(fadeMutex);
+        fadeCondition.notify_all();
+    }
+
+    void run() override;
+
+    // Starts a fade. Returns false (and does nothing) if the action is not a valid OAT_FADE.
+    // If another fade is already running on the same address, the new fade takes over from it: the old fade is
+    // cancelled and the new one starts from the value the old one last sent, rather than from its own start value.
+    bool startFade(const CueOSCAction &cueAction);
+
+    // Cancels the fade of the given action. The fade is reported as finished straight away.
+    // Returns false if no fade of that action is running.
+    bool cancelFade(ActionHandle actionHandle);
+
+    // Cancels the fade running on the given OSC address, if there is one, so a command to that address isn't
+    // overwritten by the fade's next step. Returns false if no fade is running on the address.
+    bool cancelFadeOnAddress(const InternedOSCAddress &oscAddress);
+
+    // Cancels every running fade.
+    void cancelAllFades();
+
+    // Tells the engine a cue or global epoch has been bumped, so it checks every running fade's DispatchEpoch within
+    // one tick. Doesn't lock, so it is safe to call from the message thread.
+    void epochsChanged() {
+        epochGeneration.fetch_add(1, std::memory_order_release);
+        fadeCondition.notify_all();
+    }
+
+    // When enabled, every fade step due on the same tick is sent in OSC bundles rather than as separate messages.
+    void setBundleFadeSteps(bool shouldBundle) { bundleFadeSteps = shouldBundle; }
+
+    // The step of a quantised parameter's grid (0 to quantisationSteps) a fade is on at normalisedValue. A value
+    // exactly between two steps is on the one the fade is heading towards, in either direction.
+    static int getQuantum(double normalisedValue, int quantisationSteps, bool descending);
+
+    // How long after the start of a quantised fade it crosses from quantum onto the next step towards its end.
+    static std::chrono::steady_clock::duration getTimeOfNextQuantum(int quantum, int quantisationSteps,
+                                                                    double normalisedStart, double normalisedEnd,
+                                                                    double fadeDurationMs);
+
+private:
+    typedef std::pair<std::chrono::steady_clock::time_point, size_t> HeapEntry; // Due time, slot in fades
+
+    // Pre-computes the normalised start/end values and number of increments. Returns false if the template cannot
+    // be faded.
+    bool prepareFade(ActiveFade &fade) const;
+
+    // Sends the step of a fade which is due at now, skipping any steps missed if the engine was late, and sets when
+    // the next step is due. Returns true when the fade has sent its final value.
+    bool advanceFade(ActiveFade &fade, std::chrono::steady_clock::time_point now);
+
+    // advanceFade for fades with quantisationSteps. Sends only when the quantised value changes.
+    bool advanceQuantisedFade(ActiveFade &fade, std::chrono::steady_clock::time_point now);
+
+    // Sends the exact end value and records the overrun.
+    void finishFade(ActiveFade &fade);
+
+    // Queues a single normalised value for the fade's address. It's sent by sendQueuedSteps().
+    void sendFadeValue(ActiveFade &fade, double normalisedValue);
+
+    // Sends every step queued this tick. Called with fadeMutex released, so starting, stopping and cancelling fades
+    // never waits on the network.
+    void sendQueuedSteps();
+
+    // Frees the slot of a fade whose heap entry has come up, posting its completion if not done yet. Expects fadeMutex
+    // to be held.
+    void retireFade(size_t slot);
+
+    // Posts the fade's completion and removes it from the lookup maps. Its slot stays allocated until its heap entry
+    // comes up. Expects fadeMutex to be held.
+    void finishSlot(size_t slot);
+
+    // Cancels the fade in slot. Its completion is posted straight away. Expects fadeMutex to be held.
+    void cancelSlot(size_t slot);
+
+    // Cancels every fade whose DispatchEpoch has moved on. Expects fadeMutex to be held.
+    void cancelFadesWithStaleEpochs();
+
+    const unsigned int FMMID; // The minimum duration passed before next increment for OAT_FADE actions (ms)
+    const std::chrono::milliseconds quantisedFadeMinimumStep;
+    OSCDeviceSender &oscSender;
+    ActionCompletionSink &completionSink;
+    std::atomic<bool> bundleFadeSteps{false};
+    OSCBundlePacker stepBundle; // Only used by the fade thread
+    // The steps of this tick, back to back, and where each one ends. Only used by the fade thread.
+    std::vector<char> queuedStepBytes;
+    std::vector<size_t> queuedStepEnds;
+
+    std::mutex fadeMutex; // Guards everything below
+    std::condition_variable fadeCondition;
+    std::vector<std::unique_ptr<ActiveFade>> fades; // Slots. nullptr when free.
+    std::vector<size_t> freeSlots;
+    std::vector<HeapEntry> dueHeap; // Min-heap of (due time, slot). Each occupied slot has exactly one entry.
+    std::unordered_map<ActionHandle, size_t> actionToFadeSlot;
+    // Indexed by interned address ID. Only fades which haven't been cancelled - noFadeSlot otherwise.
+    std::vector<size_t> addressToFadeSlot;
+    static constexpr size_t noFadeSlot = static_cast<size_t>(-1);
+
+    // The slot of the fade running on the address, or noFadeSlot. Expects fadeMutex to be held.
+    [[nodiscard]] size_t findFadeSlotOnAddress(const InternedOSCAddress &oscAddress) const {
+        return oscAddress.getID() < addressToFadeSlot.size() ? addressToFadeSlot[oscAddress.getID()] : noFadeSlot;
+    }
+    std::atomic<int> activeFadeCount{0}; // Lets cancelFadeOnAddress skip the lock when nothing is fading
+    std::atomic<uint64> epochGeneration{0}; // Bumped by epochsChanged()
+    uint64 lastCheckedEpochGeneration{0}; // Only used by the fade thread
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OSCFadeEngine)
+};
+
+
+class OSCCueDispatcherManager : public Thread, public Thread::Listener, public ActionCompletionSink {
 public:
     explicit OSCCueDispatcherManager(OSCDeviceSender &oscDevice, unsigned int maximumSimultaneousMessageThreads = 100,
                                      unsigned int waitFormsWhenActionQueueIsEmpty = 50);
@@ -141,13 +398,15 @@ public:
 
     ~OSCCueDispatcherManager() override {
         singleActionDispatcherPool.removeAllJobs(true, 1000);
+        fadeEngine.stopThread(1000);
     }
 
 
     void exitSignalSent() override {
         removeListener(this);
-        actionQueue.emplace(true);
+        actionQueue.push(CueOSCAction(true));
         singleActionDispatcherPool.removeAllJobs(true, 5000);
+        fadeEngine.signalThreadShouldExit();
     }
 
     void run() override;
@@ -165,22 +424,80 @@ public:
 
     void addCueToMessageQueue(const CurrentCueInfo &cueInfo);
 
-    void stopAction(const std::string &actionID, bool jassertWhenNotFound = false);
+    // An already serialised message (see CueOSCAction::compileCommandPacket) and the address it's sent to
+    struct AddressedPacket {
+        InternedOSCAddress address;
+        std::shared_ptr<const MemoryBlock> packet;
+    };
+
+    /* Has run() send packets, in order, before the next queued action. Each cancels any fade running on its address
+     * first, so the fade can't overwrite it. The packets aren't actions: they're never reported to the listeners, and
+     * can't be stopped. Doesn't block.
+     */
+    void sendPackets(std::vector<AddressedPacket> packets);
+
+    void stopAction(ActionHandle actionHandle, bool jassertWhenNotFound = false);
 
     void stopAction(const CueOSCAction& cueAction, bool jassertWhenNotFound = false) {
-        stopAction(cueAction.ID, jassertWhenNotFound);
+        stopAction(cueAction.handle, jassertWhenNotFound);
     }
 
+    /* Stops every action of the cue. Doesn't block: bumps the cue's epoch, so queued actions are dropped and running
+     * fades are cancelled within one fade tick. jassertWhenNotFound asserts if the cue was never dispatched.
+     */
     void stopAllActionsInCCI(const CurrentCueInfo &cueInfo, bool jassertWhenNotFound = false);
 
+    // Stops every action of every cue (panic). Doesn't block - see stopAllActionsInCCI.
+    void stopAllActions();
+
+    // Forgets the cue's epoch once none of its actions are queued or running, so cueEpochs only holds cues in flight.
+    // Call from the message thread.
+    void cueFinished(CueHandle cueHandle);
+
+    // Queues a completion to be reported to the listeners by run(), and wakes run() to do so. Called by the executors.
+    void postCompletion(ActionCompletion completion) override;
+
+    /* When enabled, all OAT_COMMAND actions of a cue (and all fade steps due on the same tick) are sent in OSC bundles
+     * instead of one datagram per message. This makes applying a cue as close to atomic as the console allows.
+     * Disabled by default. MainComponent applies the choice made in the OSC Device Selector, which is kept in its settings.
+     */
+    void setBundlingEnabled(bool shouldBundle) {
+        bundleCommands = shouldBundle;
+        fadeEngine.setBundleFadeSteps(shouldBundle);
+    }
+
 private:
+    bool dispatchAction(const CueOSCAction &action);
+
+    // Sends everything queued by sendPackets(). Only called by run().
+    void sendQueuedPackets();
+
+    // Reports every completed action to the listeners in one batch.
+    void notifyCompletedActions();
+
     std::vector<OSCDispatcherListener*> dispatchListeners;
-    std::unordered_map<std::string, OSCSingleActionDispatcher*> actionIDToJobMap; // Maps action ID to the job pointer
-    std::queue<CueOSCAction> actionQueue;
+    std::unordered_map<ActionHandle, OSCSingleActionDispatcher*> actionToJobMap; // Maps action handle to the job pointer
+    std::mutex jobMapMutex; // Guards actionToJobMap, as stopAction is called from the message thread
+    // Pushed from the message thread, popped by run(). 1024 actions fit before pushes spill into its overflow list.
+    MPSCRingQueue<CueOSCAction> actionQueue{1024};
+    // Pushed by the executors, drained by run(). Declared before the executors, so it outlives them. Never loses a
+    // completion: when run() falls behind, pushes spill into the queue's overflow list.
+    MPSCRingQueue<ActionCompletion> completionQueue{1024};
+    // Pushed by sendPackets(), drained by run() whenever it wakes
+    MPSCRingQueue<AddressedPacket> packetQueue{1024};
+    // Queued and running actions point at globalEpoch, so it is declared before the executors to outlive them
+    std::atomic<uint64> globalEpoch{0}; // Bumped by stopAllActions()
+    // Cue handle to that cue's epoch. Only touched from the thread queueing and stopping cues (message thread).
+    // Entries are removed when the cue is stopped or finishes (cueFinished).
+    std::unordered_map<CueHandle, std::shared_ptr<std::atomic<uint64>>> cueEpochs;
     const unsigned int maximumSimultaneousMessageThreads;
-    const unsigned int waitMSFromWhenActionQueueIsEmpty; // Time to wait when action queue is empty
+    const unsigned int waitMSFromWhenActionQueueIsEmpty; // Longest run() sleeps for. Completions wake it sooner.
     OSCDeviceSender &oscSender; // The OSC Device Sender to use for sending messages
-    ThreadPool singleActionDispatcherPool; // Pool for single action dispatchers
+    ThreadPool singleActionDispatcherPool; // Pool for single action dispatchers (OAT_COMMAND only)
+    OSCFadeEngine fadeEngine; // Runs every OAT_FADE from a single thread
+    std::vector<ActionHandle> completedActions; // The batch being reported by notifyCompletedActions(). Reused.
+    std::atomic<bool> bundleCommands{false};
+    OSCBundlePacker commandBundle; // Only used by run()
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OSCCueDispatcherManager)
 };
@@ -188,8 +505,9 @@ private:
 
 class OSCDeviceSelectorComponent : public Component, public TextEditor::Listener, public TextButton::Listener {
 public:
-    // UI for selecting OSC Device. Allows user to input IP and port.
-    OSCDeviceSelectorComponent() {
+    // UI for selecting OSC Device. Allows user to input IP and port. bundleCommands is the toggle's starting state.
+    explicit OSCDeviceSelectorComponent(bool bundleCommands = false) {
+        bundleToggle.setToggleState(bundleCommands, dontSendNotification);
         setOpaque(true);
         setSize(600, 400);
         initaliseComponents();
@@ -265,11 +583,13 @@ public:
     }
 
 
+    // The device is blank apart from bundleCommands when the inputs are invalid
     OSCDevice getDevice() {
+        OSCDevice device;
+        device.bundleCommands = bundleToggle.getToggleState();
         if (!validateTextEditorOutputs()) {
-            return {};
+            return device;
         }
-        OSCDevice device;
         device.ipAddress = ipAddressString;
         device.port = portString.getIntValue();
         device.deviceName = deviceNameString;
@@ -297,6 +617,7 @@ private:
 
     TextButton applyButton {"Apply", "Apply changes to OSC Device"};
     TextButton cancelButton {"Cancel", "Cancel changes to OSC Device"};
+    ToggleButton bundleToggle {"Send each cue's commands as one OSC bundle"};
 
     /*
     std::vector<juce::Component *> getComps() {
@@ -343,12 +664,12 @@ public:
         // Called when OSC Device Selector Window is closed.
         virtual void oscDevSelClosed() = 0;
     };
-    explicit OSCDeviceSelectorWindow(const String &name = "OSC Device Selector")
+    explicit OSCDeviceSelectorWindow(bool bundleCommands = false, const String &name = "OSC Device Selector")
         : DocumentWindow(name,
                          Desktop::getInstance().getDefaultLookAndFeel()
                          .findColour(ResizableWindow::backgroundColourId),
                          DocumentWindow::allButtons) {
-        oscDeviceSelectorComponent.reset(new OSCDeviceSelectorComponent());
+        oscDeviceSelectorComponent.reset(new OSCDeviceSelectorComponent(bundleCommands));
         setUsingNativeTitleBar(true);
         setFullScreen(false);
         setContentOwned(oscDeviceSelectorComponent.get(), true);
@@ -0,0 +1,559 @@
+/*
+  ==============================================================================
+
+    ShowFile.cpp
+    Created: 17 Oct 2026 10:12:40am
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#include "ShowFile.h"
+#include <map>
+
+using namespace ShowFileFormat;
+
+
+namespace {
+    constexpr uint64 sectionAlignment = 8;
+
+    uint64 alignUp(uint64 offset) {
+        return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+    }
+
+    // True if count records of recordSize starting at offset lie inside a file of fileSize bytes
+    bool tableFits(uint64 offset, uint64 count, uint64 recordSize, uint64 fileSize) {
+        if (offset % sectionAlignment != 0 || offset > fileSize) {
+            return false;
+        }
+        return count <= (fileSize - offset) / recordSize;
+    }
+
+    // Builds the string table, storing each distinct string once.
+    class StringTableWriter {
+    public:
+        StringRef add(const std::string &string) {
+            const auto found = refs.find(string);
+            if (found != refs.end()) {
+                return found->second;
+            }
+            const StringRef ref{static_cast<uint32>(data.size()), static_cast<uint32>(string.size())};
+            data.append(string);
+            data.push_back('\0');
+            refs.emplace(string, ref);
+            return ref;
+        }
+
+        StringRef add(const String &string) { return add(string.toStdString()); }
+
+        [[nodiscard]] const std::string &getData() const { return data; }
+
+    private:
+        std::string data;
+        std::unordered_map<std::string, StringRef> refs;
+    };
+
+    uint8 storeValue(const ValueStorer &value, int32 &intValue, float &floatValue, StringRef &stringValue,
+                     StringTableWriter &stringTable) {
+        switch (value._meta_PARAMTYPE) {
+            case INT:
+                intValue = value.intValue;
+                break;
+            case _GENERIC_FLOAT:
+                floatValue = value.floatValue;
+                break;
+            case STRING:
+                stringValue = stringTable.add(value.stringValue.toStdString());
+                break;
+            default:
+                break;
+        }
+        return static_cast<uint8>(value._meta_PARAMTYPE);
+    }
+
+    uint8 storeValue(const FadeValue &value, int32 &intValue, float &floatValue) {
+        intValue = value.intValue;
+        floatValue = value.floatValue;
+        return static_cast<uint8>(value._meta_PARAMTYPE);
+    }
+
+    bool isValueType(uint8 type) {
+        return type == INT || type == _GENERIC_FLOAT || type == STRING || type == BLANK;
+    }
+
+    template<typename Record>
+    void writeTable(OutputStream &out, const std::vector<Record> &table) {
+        out.write(table.data(), table.size() * sizeof(Record));
+    }
+
+    void padTo(OutputStream &out, uint64 offset) {
+        jassert(static_cast<uint64>(out.getPosition()) <= offset);
+        while (static_cast<uint64>(out.getPosition()) < offset) {
+            out.writeByte(0);
+        }
+    }
+}
+
+
+Result ShowFile::open(const File &fileToOpen) {
+    close();
+    auto mapped = std::make_unique<MemoryMappedFile>(fileToOpen, MemoryMappedFile::readOnly);
+    if (mapped->getData() == nullptr) {
+        return Result::fail("Couldn't open " + fileToOpen.getFullPathName());
+    }
+    const auto result = attach(mapped->getData(), static_cast<uint64>(mapped->getSize()));
+    if (result.wasOk()) {
+        file = fileToOpen;
+        mappedFile = std::move(mapped);
+    }
+    return result;
+}
+
+
+Result ShowFile::open(const void *data, size_t size) {
+    close();
+    return attach(data, size);
+}
+
+
+Result ShowFile::attach(const void *fileData, uint64 size) {
+#if JUCE_BIG_ENDIAN
+    ignoreUnused(fileData, size);
+    return Result::fail("Show files can only be read on little endian machines");
+#else
+    const auto *data = static_cast<const char *>(fileData);
+    if (size < sizeof(Header)) {
+        return Result::fail("Not a show file (too short)");
+    }
+    const auto *fileHeader = reinterpret_cast<const Header *>(data);
+    if (std::memcmp(fileHeader->magic, magic, sizeof(magic)) != 0) {
+        return Result::fail("Not a show file");
+    }
+    if (fileHeader->version != version || fileHeader->headerSize != sizeof(Header)) {
+        return Result::fail("Unsupported show file version " + String(fileHeader->version));
+    }
+    if (!tableFits(fileHeader->cueTableOffset, fileHeader->cueCount, sizeof(CueRecord), size) ||
+        !tableFits(fileHeader->actionTableOffset, fileHeader->actionCount, sizeof(ActionRecord), size) ||
+        !tableFits(fileHeader->templateTableOffset, fileHeader->templateCount, sizeof(TemplateRecord), size) ||
+        !tableFits(fileHeader->optionTableOffset, fileHeader->optionCount, sizeof(StringRef), size) ||
+        !tableFits(fileHeader->addressTableOffset, fileHeader->addressCount, sizeof(StringRef), size) ||
+        !tableFits(fileHeader->stringTableOffset, fileHeader->stringTableSize, 1, size)) {
+        return Result::fail("Show file is truncated or corrupt");
+    }
+
+    header = fileHeader;
+    cues = reinterpret_cast<const CueRecord *>(data + header->cueTableOffset);
+    actions = reinterpret_cast<const ActionRecord *>(data + header->actionTableOffset);
+    templates = reinterpret_cast<const TemplateRecord *>(data + header->templateTableOffset);
+    options = reinterpret_cast<const StringRef *>(data + header->optionTableOffset);
+    addresses = reinterpret_cast<const StringRef *>(data + header->addressTableOffset);
+    strings = data + header->stringTableOffset;
+    addressCache.assign(header->addressCount, std::nullopt);
+    templateCache.assign(header->templateCount, std::nullopt);
+    return Result::ok();
+#endif
+}
+
+
+void ShowFile::close() {
+    // The lookup's keys point into the mapping, so it has to go first
+    cueIndexByInternalID.clear();
+    addressCache.clear();
+    templateCache.clear();
+    header = nullptr;
+    cues = nullptr;
+    actions = nullptr;
+    templates = nullptr;
+    options = nullptr;
+    addresses = nullptr;
+    strings = nullptr;
+    mappedFile.reset();
+    file = File();
+}
+
+
+std::string_view ShowFile::getString(const StringRef &ref) const {
+    if (!isOpen() || ref.offset > header->stringTableSize || ref.length > header->stringTableSize - ref.offset) {
+        jassert(isOpen()); // Out of range refs mean a corrupt file; reading a closed ShowFile is a bug
+        return {};
+    }
+    return {strings + ref.offset, ref.length};
+}
+
+
+uint32 ShowFile::findCue(std::string_view internalID) {
+    if (!isOpen()) {
+        return noIndex;
+    }
+    if (cueIndexByInternalID.empty() && header->cueCount > 0) {
+        cueIndexByInternalID.reserve(header->cueCount);
+        for (uint32 i = 0; i < header->cueCount; i++) {
+            cueIndexByInternalID.emplace(getString(cues[i].internalID), i);
+        }
+    }
+    const auto found = cueIndexByInternalID.find(internalID);
+    return found == cueIndexByInternalID.end() ? noIndex : found->second;
+}
+
+
+const OSCAddressPattern *ShowFile::getAddress(uint32 index) {
+    if (index >= addressCache.size()) {
+        jassertfalse; // Corrupt file
+        return nullptr;
+    }
+    auto &cached = addressCache[index];
+    if (!cached.has_value()) {
+        try {
+            cached.emplace(toString(addresses[index]));
+        } catch (const OSCFormatError &) {
+            jassertfalse; // Not an OSC address, so the file is corrupt
+            return nullptr;
+        }
+    }
+    return &cached.value();
+}
+
+
+const ArgumentTemplateRef *ShowFile::getTemplate(uint32 index) {
+    if (index >= templateCache.size()) {
+        jassertfalse; // Corrupt file
+        return nullptr;
+    }
+    auto &cached = templateCache[index];
+    if (cached.has_value()) {
+        return &cached.value();
+    }
+    const auto &record = templates[index];
+    const auto unit = static_cast<Units>(jlimit<int>(HERTZ, NONE, record.unit));
+    const auto name = toStdString(record.name);
+    const auto verboseName = toStdString(record.verboseName);
+    const auto description = toStdString(record.description);
+
+    std::vector<std::string> values;
+    if (record.kind != TemplateRecord::NONITER) {
+        if (record.firstOption > header->optionCount || record.optionCount > header->optionCount - record.firstOption) {
+            jassertfalse; // Corrupt file
+            return nullptr;
+        }
+        values.reserve(record.optionCount);
+        for (uint32 i = 0; i < record.optionCount; i++) {
+            values.push_back(toStdString(options[record.firstOption + i]));
+        }
+    }
+
+    ArgumentTemplateRef ref;
+    switch (record.kind) {
+        case TemplateRecord::NONITER:
+            if (record.paramType > BLANK) {
+                jassertfalse; // Corrupt file
+                return nullptr;
+            }
+            ref = NonIter(name, verboseName, description, record.defaultInt, record.intMin, record.intMax,
+                          record.defaultFloat, record.floatMin, record.floatMax, toStdString(record.defaultString),
+                          static_cast<ParamType>(record.paramType), unit, record.normalisedInverted != 0);
+            break;
+        case TemplateRecord::ENUMPARAM:
+            ref = EnumParam(name, verboseName, description, values, unit, true);
+            break;
+        case TemplateRecord::OPTIONPARAM:
+            ref = OptionParam(name, verboseName, description, values, unit, true);
+            break;
+        default:
+            jassertfalse; // Corrupt file
+            return nullptr;
+    }
+    // Resolve once here, so every action using the template gets the table's entry without comparing it again
+    cached.emplace(ref.resolveAgainstTable(toStdString(record.tableID)));
+    return &cached.value();
+}
+
+
+std::optional<CueOSCAction> ShowFile::buildAction(const ActionRecord &record) {
+    const auto *address = getAddress(record.addressIndex);
+    const auto *argumentTemplate = getTemplate(record.templateIndex);
+    if (address == nullptr || argumentTemplate == nullptr) {
+        return std::nullopt;
+    }
+    const auto templateID = toStdString(templates[record.templateIndex].tableID);
+    const auto actionID = toStdString(record.actionID);
+
+    if (record.oat == OAT_COMMAND) {
+        if (!isValueType(record.argumentType)) {
+            jassertfalse; // Corrupt file
+            return std::nullopt;
+        }
+        ValueStorer argument;
+        switch (record.argumentType) {
+            case INT:
+                argument.changeStore(static_cast<int>(record.argumentInt));
+                break;
+            case _GENERIC_FLOAT:
+                argument.changeStore(record.argumentFloat);
+                break;
+            case STRING:
+                argument.changeStore(toStdString(record.argumentString));
+                break;
+            default:
+                break;
+        }
+        return CueOSCAction(*address, *argumentTemplate, argument, templateID, actionID);
+    }
+    if (record.oat == OAT_FADE) {
+        if (argumentTemplate->getNonIter() == nullptr) {
+            jassertfalse; // Only NonIters can be faded, so the file is corrupt
+            return std::nullopt;
+        }
+        const auto fadeValue = [](uint8 type, int32 intValue, float floatValue) -> FadeValue {
+            if (type == INT) {
+                return ValueStorer(static_cast<int>(intValue));
+            }
+            if (type == _GENERIC_FLOAT) {
+                return ValueStorer(floatValue);
+            }
+            return {};
+        };
+        return CueOSCAction(*address, record.fadeTime, *argumentTemplate,
+                            fadeValue(record.startType, record.startInt, record.startFloat),
+                            fadeValue(record.endType, record.endInt, record.endFloat), templateID, actionID);
+    }
+    jassertfalse; // EXIT_THREAD is never saved, so the file is corrupt
+    return std::nullopt;
+}
+
+
+const CueRecord *ShowFile::getCue(uint32 index) const {
+    if (!isOpen() || index >= header->cueCount) {
+        jassertfalse;
+        return nullptr;
+    }
+    return &cues[index];
+}
+
+
+const ActionRecord *ShowFile::getAction(uint32 index) const {
+    if (!isOpen() || index >= header->actionCount) {
+        jassertfalse;
+        return nullptr;
+    }
+    return &actions[index];
+}
+
+
+std::optional<CurrentCueInfo> ShowFile::buildCue(uint32 index, size_t &droppedActions) {
+    const auto *cue = getCue(index);
+    if (cue == nullptr) {
+        return std::nullopt;
+    }
+    std::vector<CueOSCAction> cueActions;
+    if (cue->firstAction > header->actionCount || cue->actionCount > header->actionCount - cue->firstAction) {
+        jassertfalse; // Corrupt file. Keep the cue, but without its actions.
+        droppedActions += cue->actionCount;
+    } else {
+        cueActions.reserve(cue->actionCount);
+        for (uint32 a = cue->firstAction; a < cue->firstAction + cue->actionCount; a++) {
+            if (auto action = buildAction(actions[a])) {
+                cueActions.push_back(std::move(*action));
+            } else {
+                droppedActions++;
+            }
+        }
+    }
+    return CurrentCueInfo(toString(cue->id), toString(cue->name), toString(cue->description), cueActions,
+                          toStdString(cue->internalID));
+}
+
+
+std::vector<CurrentCueInfo> ShowFile::buildCues(size_t &droppedActions) {
+    droppedActions = 0;
+    std::vector<CurrentCueInfo> built;
+    if (!isOpen()) {
+        jassertfalse;
+        return built;
+    }
+    built.reserve(header->cueCount);
+    for (uint32 i = 0; i < header->cueCount; i++) {
+        built.push_back(std::move(*buildCue(i, droppedActions)));
+    }
+    return built;
+}
+
+
+Result ShowFile::write(OutputStream &output, size_t cueCount, const CueSource &getCue, const String &showName,
+                       const String &showDescription) {
+#if JUCE_BIG_ENDIAN
+    ignoreUnused(output, cueCount, getCue, showName, showDescription);
+    return Result::fail("Show files can only be written on little endian machines");
+#else
+    StringTableWriter stringTable;
+    std::vector<CueRecord> cueTable;
+    std::vector<ActionRecord> actionTable;
+    std::vector<TemplateRecord> templateTable;
+    std::vector<StringRef> optionTable;
+    std::vector<StringRef> addressTable;
+
+    std::unordered_map<uint32, uint32> addressIndexByID; // InternedOSCAddress ID to address table index
+    // Templates are shared between actions, so each is written once. Keyed on the template itself and the ID it
+    // was resolved against.
+    std::map<std::pair<const void *, std::string>, uint32> templateIndexByTemplate;
+
+    const auto addTemplate = [&](const CueOSCAction &action) -> uint32 {
+        const auto &ref = action.argumentTemplate;
+        const void *target = ref.getNonIter();
+        if (target == nullptr) { target = ref.getEnumParam(); }
+        if (target == nullptr) { target = ref.getOptionParam(); }
+        const auto key = std::make_pair(target, action.argumentTemplateID);
+        if (const auto found = templateIndexByTemplate.find(key); found != templateIndexByTemplate.end()) {
+            return found->second;
+        }
+
+        TemplateRecord record{};
+        record.tableID = stringTable.add(action.argumentTemplateID);
+        const auto addValues = [&](const std::vector<std::string> &values) {
+            record.firstOption = static_cast<uint32>(optionTable.size());
+            record.optionCount = static_cast<uint32>(values.size());
+            for (const auto &value: values) {
+                optionTable.push_back(stringTable.add(value));
+            }
+        };
+        if (const auto *nonIter = ref.getNonIter()) {
+            record.kind = TemplateRecord::NONITER;
+            record.paramType = static_cast<uint8>(nonIter->_meta_PARAMTYPE);
+            record.unit = static_cast<uint8>(nonIter->_meta_UNIT);
+            record.normalisedInverted = nonIter->normalisedInverted ? 1 : 0;
+            record.defaultInt = nonIter->defaultIntValue;
+            record.intMin = nonIter->intMin;
+            record.intMax = nonIter->intMax;
+            record.defaultFloat = nonIter->defaultFloatValue;
+            record.floatMin = nonIter->floatMin;
+            record.floatMax = nonIter->floatMax;
+            record.name = stringTable.add(nonIter->name);
+            record.verboseName = stringTable.add(nonIter->verboseName);
+            record.description = stringTable.add(nonIter->description);
+            record.defaultString = stringTable.add(nonIter->defaultStringValue);
+        } else if (const auto *enumParam = ref.getEnumParam()) {
+            record.kind = TemplateRecord::ENUMPARAM;
+            record.paramType = static_cast<uint8>(enumParam->_meta_PARAMTYPE);
+            record.unit = static_cast<uint8>(enumParam->_meta_UNIT);
+            record.name = stringTable.add(enumParam->name);
+            record.verboseName = stringTable.add(enumParam->verboseName);
+            record.description = stringTable.add(enumParam->description);
+            addValues(enumParam->value);
+        } else if (const auto *optionParam = ref.getOptionParam()) {
+            record.kind = TemplateRecord::OPTIONPARAM;
+            record.paramType = static_cast<uint8>(optionParam->_meta_PARAMTYPE);
+            record.unit = static_cast<uint8>(optionParam->_meta_UNIT);
+            record.name = stringTable.add(optionParam->name);
+            record.verboseName = stringTable.add(optionParam->verboseName);
+            record.description = stringTable.add(optionParam->description);
+            addValues(optionParam->value);
+        }
+        const auto index = static_cast<uint32>(templateTable.size());
+        templateTable.push_back(record);
+        templateIndexByTemplate.emplace(key, index);
+        return index;
+    };
+
+    const auto addAddress = [&](const InternedOSCAddress &address) -> uint32 {
+        const auto [found, inserted] = addressIndexByID.emplace(address.getID(),
+                                                                static_cast<uint32>(addressTable.size()));
+        if (inserted) {
+            addressTable.push_back(stringTable.add(address.toString()));
+        }
+        return found->second;
+    };
+
+    cueTable.reserve(cueCount);
+    for (size_t i = 0; i < cueCount; i++) {
+        const auto &cci = getCue(i);
+        CueRecord cue{};
+        cue.id = stringTable.add(cci.id);
+        cue.name = stringTable.add(cci.name);
+        cue.description = stringTable.add(cci.description);
+        cue.internalID = stringTable.add(cci.getInternalID());
+        cue.firstAction = static_cast<uint32>(actionTable.size());
+        for (const auto &action: cci.actions) {
+            if (action.oat == EXIT_THREAD) {
+                continue;
+            }
+            ActionRecord record{};
+            record.oat = static_cast<uint8>(action.oat);
+            record.addressIndex = addAddress(action.oscAddress);
+            record.templateIndex = addTemplate(action);
+            record.actionID = stringTable.add(action.ID);
+            if (action.oat == OAT_COMMAND) {
+                record.argumentType = storeValue(action.argument, record.argumentInt, record.argumentFloat,
+                                                 record.argumentString, stringTable);
+            } else {
+                record.fadeTime = action.fadeTime;
+                record.startType = storeValue(action.startValue, record.startInt, record.startFloat);
+                record.endType = storeValue(action.endValue, record.endInt, record.endFloat);
+            }
+            actionTable.push_back(record);
+        }
+        cue.actionCount = static_cast<uint32>(actionTable.size()) - cue.firstAction;
+        cueTable.push_back(cue);
+    }
+
+    Header fileHeader{};
+    std::memcpy(fileHeader.magic, magic, sizeof(magic));
+    fileHeader.version = version;
+    fileHeader.headerSize = sizeof(Header);
+    fileHeader.cueCount = static_cast<uint32>(cueTable.size());
+    fileHeader.actionCount = static_cast<uint32>(actionTable.size());
+    fileHeader.templateCount = static_cast<uint32>(templateTable.size());
+    fileHeader.optionCount = static_cast<uint32>(optionTable.size());
+    fileHeader.addressCount = static_cast<uint32>(addressTable.size());
+    fileHeader.showName = stringTable.add(showName);
+    fileHeader.showDescription = stringTable.add(showDescription);
+    fileHeader.cueTableOffset = alignUp(sizeof(Header));
+    fileHeader.actionTableOffset = alignUp(fileHeader.cueTableOffset + cueTable.size() * sizeof(CueRecord));
+    fileHeader.templateTableOffset = alignUp(fileHeader.actionTableOffset + actionTable.size() * sizeof(ActionRecord));
+    fileHeader.optionTableOffset = alignUp(fileHeader.templateTableOffset + templateTable.size() * sizeof(TemplateRecord));
+    fileHeader.addressTableOffset = alignUp(fileHeader.optionTableOffset + optionTable.size() * sizeof(StringRef));
+    fileHeader.stringTableOffset = alignUp(fileHeader.addressTableOffset + addressTable.size() * sizeof(StringRef));
+    fileHeader.stringTableSize = stringTable.getData().size();
+
+    const auto start = static_cast<uint64>(output.getPosition());
+    output.write(&fileHeader, sizeof(Header));
+    padTo(output, start + fileHeader.cueTableOffset);
+    writeTable(output, cueTable);
+    padTo(output, start + fileHeader.actionTableOffset);
+    writeTable(output, actionTable);
+    padTo(output, start + fileHeader.templateTableOffset);
+    writeTable(output, templateTable);
+    padTo(output, start + fileHeader.optionTableOffset);
+    writeTable(output, optionTable);
+    padTo(output, start + fileHeader.addressTableOffset);
+    writeTable(output, addressTable);
+    padTo(output, start + fileHeader.stringTableOffset);
+    output.write(stringTable.getData().data(), stringTable.getData().size());
+    return Result::ok();
+#endif
+}
+
+
+Result ShowFile::write(const File &destination, CurrentCueInfoVector &cciVector, const String &showName,
+                       const String &showDescription) {
+    TemporaryFile temporaryFile(destination);
+    {
+        FileOutputStream out(temporaryFile.getFile());
+        if (out.failedToOpen()) {
+            return out.getStatus();
+        }
+        const auto result = write(out, cciVector.getSize(),
+                                  [&cciVector](size_t index) -> const CurrentCueInfo & {
+                                      return cciVector.getCurrentCueInfoByIndex(index);
+                                  }, showName, showDescription);
+        if (result.failed()) {
+            return result;
+        }
+        out.flush();
+        if (out.getStatus().failed()) {
+            return out.getStatus();
+        }
+    }
+    if (!temporaryFile.overwriteTargetFileWithTemporary()) {
+        return Result::fail("Couldn't replace " + destination.getFullPathName());
+    }
+    return Result::ok();
+}
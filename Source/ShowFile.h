@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    ShowFile.h
+    Created: 17 Oct 2026 10:12:40am
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include "Helpers.h"
+
+
+/* The binary show file format. A show file is laid out as:
+ *   Header | cue table | action table | template table | option table | address table | string table
+ * Every table is an array of fixed-size records starting on an 8-byte boundary, so the file can be memory mapped and
+ * read in place. Strings (names, IDs, addresses...) are never stored in a record, only referred to by a StringRef
+ * into the string table. Each cue owns the actions [firstAction, firstAction + actionCount) of the action table, and
+ * each action refers to its address and argument template by index. Everything is in little endian byte order.
+ *
+ * Bump version whenever a record changes. Older versions are rejected rather than migrated.
+ */
+namespace ShowFileFormat {
+    constexpr char magic[8] = {'X', 'M', '3', '2', 'S', 'H', 'O', 'W'};
+    constexpr uint32 version = 1;
+    constexpr uint32 noIndex = 0xFFFFFFFF;
+
+    // A string in the string table. The string is followed by a NUL, which length doesn't count.
+    struct StringRef {
+        uint32 offset;
+        uint32 length;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32 version;
+        uint32 headerSize; // sizeof(Header)
+        uint32 cueCount;
+        uint32 actionCount;
+        uint32 templateCount;
+        uint32 optionCount;
+        uint32 addressCount;
+        StringRef showName;
+        StringRef showDescription;
+        uint32 reserved;
+        uint64 cueTableOffset;
+        uint64 actionTableOffset;
+        uint64 templateTableOffset;
+        uint64 optionTableOffset;
+        uint64 addressTableOffset;
+        uint64 stringTableOffset;
+        uint64 stringTableSize;
+    };
+
+    struct CueRecord {
+        StringRef id;
+        StringRef name;
+        StringRef description;
+        StringRef internalID;
+        uint32 firstAction;
+        uint32 actionCount;
+    };
+
+    struct ActionRecord {
+        uint8 oat; // OSCActionType
+        uint8 argumentType; // ParamType of argument, for OAT_COMMAND
+        uint8 startType; // ParamType of startValue, for OAT_FADE
+        uint8 endType; // ParamType of endValue, for OAT_FADE
+        uint32 addressIndex; // Into the address table
+        uint32 templateIndex; // Into the template table
+        float fadeTime;
+        int32 argumentInt;
+        float argumentFloat;
+        int32 startInt;
+        float startFloat;
+        int32 endInt;
+        float endFloat;
+        StringRef argumentString;
+        StringRef actionID; // CueOSCAction::ID
+    };
+
+    // A NonIter, EnumParam or OptionParam. Enum and option values are optionCount StringRefs in the option table.
+    struct TemplateRecord {
+        enum Kind : uint8 { NONITER, ENUMPARAM, OPTIONPARAM };
+
+        uint8 kind;
+        uint8 paramType;
+        uint8 unit;
+        uint8 normalisedInverted;
+        int32 defaultInt;
+        int32 intMin;
+        int32 intMax;
+        float defaultFloat;
+        float floatMin;
+        float floatMax;
+        uint32 firstOption;
+        uint32 optionCount;
+        StringRef tableID; // The action's argumentTemplateID. Empty when the template isn't from the template table.
+        StringRef name;
+        StringRef verboseName;
+        StringRef description;
+        StringRef defaultString;
+    };
+
+    static_assert(sizeof(StringRef) == 8, "Show file records must not change size");
+    static_assert(sizeof(Header) == 112, "Show file records must not change size");
+    static_assert(sizeof(CueRecord) == 40, "Show file records must not change size");
+    static_assert(sizeof(ActionRecord) == 56, "Show file records must not change size");
+    static_assert(sizeof(TemplateRecord) == 76, "Show file records must not change size");
+}
+
+
+/* A show file, memory mapped and read in place. Opening only checks the header and that every table lies inside the
+ * file, so it costs the same for any size of show. Records are bounds checked when they're read. The cue lookup by
+ * internal ID, and the addresses and templates the actions share, are only built when first needed.
+ * The show's name, counts, records and lookups never leave the mapping. Cues do when they're built: CurrentCueInfoVector
+ * owns and edits its cues, so each is copied out of the file exactly once (and moved from then on) when loaded.
+ */
+class ShowFile {
+public:
+    // Maps the file and validates its header. On failure, the ShowFile is left closed.
+    Result open(const File &file);
+
+    // Reads a show file already in memory, e.g., one embedded in another file. data must outlive the ShowFile (or
+    // the next open() or close()).
+    Result open(const void *data, size_t size);
+
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return header != nullptr; }
+
+    [[nodiscard]] const File &getFile() const { return file; }
+
+    [[nodiscard]] uint32 getCueCount() const { return isOpen() ? header->cueCount : 0; }
+
+    [[nodiscard]] uint32 getActionCount() const { return isOpen() ? header->actionCount : 0; }
+
+    [[nodiscard]] String getShowName() const { return isOpen() ? toString(header->showName) : String(); }
+
+    [[nodiscard]] String getShowDescription() const {
+        return isOpen() ? toString(header->showDescription) : String();
+    }
+
+    // nullptr (and jassert) if index >= getCueCount()
+    [[nodiscard]] const ShowFileFormat::CueRecord *getCue(uint32 index) const;
+
+    // nullptr (and jassert) if index >= getActionCount()
+    [[nodiscard]] const ShowFileFormat::ActionRecord *getAction(uint32 index) const;
+
+    // Returns an empty string for a StringRef outside the string table
+    [[nodiscard]] std::string_view getString(const ShowFileFormat::StringRef &ref) const;
+
+    // Index of the cue saved with this internal ID, or ShowFileFormat::noIndex.
+    [[nodiscard]] uint32 findCue(std::string_view internalID);
+
+    /* Builds the CurrentCueInfo for one cue, keeping its saved IDs. Corrupt action records (a bad address or template
+     * index, type or value, or a cue whose action range is outside the action table) are left out, and added to
+     * droppedActions so the caller can tell the user. std::nullopt if index >= getCueCount().
+     */
+    std::optional<CurrentCueInfo> buildCue(uint32 index, size_t &droppedActions);
+
+    // buildCue() for every cue, in order. droppedActions is set to the number of action records left out.
+    std::vector<CurrentCueInfo> buildCues(size_t &droppedActions);
+
+    using CueSource = std::function<const CurrentCueInfo &(size_t index)>;
+
+    // Writes a show of cueCount cues, fetching each with getCue, at the stream's current position.
+    static Result write(OutputStream &output, size_t cueCount, const CueSource &getCue, const String &showName,
+                        const String &showDescription);
+
+    // Writes the show to destination, replacing it only once the whole show is written.
+    static Result write(const File &destination, CurrentCueInfoVector &cciVector, const String &showName,
+                        const String &showDescription);
+
+private:
+    File file; // Empty when reading from memory
+    std::unique_ptr<MemoryMappedFile> mappedFile; // nullptr when reading from memory
+
+    const ShowFileFormat::Header *header{nullptr};
+    const ShowFileFormat::CueRecord *cues{nullptr};
+    const ShowFileFormat::ActionRecord *actions{nullptr};
+    const ShowFileFormat::TemplateRecord *templates{nullptr};
+    const ShowFileFormat::StringRef *options{nullptr};
+    const ShowFileFormat::StringRef *addresses{nullptr};
+    const char *strings{nullptr};
+
+    // Built lazily
+    std::unordered_map<std::string_view, uint32> cueIndexByInternalID;
+    std::vector<std::optional<OSCAddressPattern>> addressCache;
+    std::vector<std::optional<ArgumentTemplateRef>> templateCache;
+
+    [[nodiscard]] String toString(const ShowFileFormat::StringRef &ref) const {
+        const auto view = getString(ref);
+        return String::fromUTF8(view.data(), static_cast<int>(view.size()));
+    }
+
+    std::string toStdString(const ShowFileFormat::StringRef &ref) const {
+        const auto view = getString(ref);
+        return std::string(view);
+    }
+
+    // Validates the header and points the tables into data
+    Result attach(const void *data, uint64 size);
+
+    const OSCAddressPattern *getAddress(uint32 index);
+    const ArgumentTemplateRef *getTemplate(uint32 index);
+    std::optional<CueOSCAction> buildAction(const ShowFileFormat::ActionRecord &record);
+};
@@ -0,0 +1,727 @@
+/*
+  ==============================================================================
+
+    ShowJSON.cpp
+    Created: 17 Oct 2026 2:41:05pm
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#include "ShowJSON.h"
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+
+
+namespace {
+    const char *const formatName = "xm32show";
+
+    const std::array<const char *, BLANK + 1> paramTypeNames = {
+        "LINF", "LOGF", "ENUM", "STRING", "INT", "LEVEL_1024", "LEVEL_161", "BITSET", "OPTION", "_GENERIC_FLOAT", "BLANK"
+    };
+    const std::array<const char *, NONE + 1> unitNames = {"HERTZ", "DB", "MS", "NONE"};
+
+    template<size_t size>
+    int indexOfName(const std::array<const char *, size> &names, const std::string &name) {
+        for (size_t i = 0; i < size; i++) {
+            if (name == names[i]) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+
+    // Thrown inside the reader, and turned into a failed Result by Reader::read()
+    struct ParseError {
+        String message;
+    };
+
+
+    /* A pull parser for exactly the JSON the show format needs. Values are read one at a time straight off the
+     * stream: objects and arrays are walked with forEachMember() and forEachElement(), so nothing but the current
+     * string or number is ever buffered. Nesting deeper than maxDepth is rejected rather than recursed into.
+     */
+    class JSONPullParser {
+    public:
+        static constexpr int maxDepth = 64;
+
+        JSONPullParser(InputStream &source, const ShowJSON::ProgressCallback &onProgress):
+            input(&source, 1 << 16, false), totalLength(source.getTotalLength()), onProgress(onProgress) {}
+
+        // Calls onMember(key) for every member of the next object. onMember must read (or skip) the member's value.
+        template<typename Fn>
+        void forEachMember(Fn &&onMember) {
+            expect('{');
+            DepthGuard guard(*this);
+            if (peekNonWhitespace() == '}') {
+                next();
+                return;
+            }
+            while (true) {
+                const auto key = readString();
+                expect(':');
+                onMember(key);
+                const auto separator = nextNonWhitespace();
+                if (separator == '}') { return; }
+                if (separator != ',') { fail("Expected ',' or '}'"); }
+            }
+        }
+
+        // Calls onElement() for every element of the next array. onElement must read (or skip) the element.
+        template<typename Fn>
+        void forEachElement(Fn &&onElement) {
+            expect('[');
+            DepthGuard guard(*this);
+            if (peekNonWhitespace() == ']') {
+                next();
+                return;
+            }
+            while (true) {
+                onElement();
+                const auto separator = nextNonWhitespace();
+                if (separator == ']') { return; }
+                if (separator != ',') { fail("Expected ',' or ']'"); }
+            }
+        }
+
+        std::string readString() {
+            expect('"');
+            std::string string;
+            while (true) {
+                const auto c = next();
+                if (c == '"') { return string; }
+                if (c == '\\') {
+                    readEscape(string);
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    fail("Control character in string");
+                } else {
+                    string.push_back(c);
+                }
+            }
+        }
+
+        double readNumber() {
+            peekNonWhitespace();
+            char digits[64];
+            size_t length = 0;
+            while (length < sizeof(digits) - 1) {
+                const auto c = peek();
+                if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+                    break;
+                }
+                digits[length++] = next();
+            }
+            digits[length] = '\0';
+            char *end = nullptr;
+            const double number = std::strtod(digits, &end);
+            if (length == 0 || end != digits + length) {
+                fail("Expected a number");
+            }
+            return number;
+        }
+
+        int readInt() {
+            const auto number = readNumber();
+            if (number != std::floor(number) || number < std::numeric_limits<int>::min() ||
+                number > std::numeric_limits<int>::max()) {
+                fail("Expected an integer");
+            }
+            return static_cast<int>(number);
+        }
+
+        // A number, or one of the strings JSONWriter::number() writes for NaN and the infinities
+        float readFloat() {
+            if (peekNonWhitespace() != '"') {
+                return static_cast<float>(readNumber());
+            }
+            const auto name = readString();
+            if (name == "NaN") { return std::numeric_limits<float>::quiet_NaN(); }
+            if (name == "Infinity") { return std::numeric_limits<float>::infinity(); }
+            if (name == "-Infinity") { return -std::numeric_limits<float>::infinity(); }
+            fail("Expected a number");
+        }
+
+        bool readBool() {
+            if (peekNonWhitespace() == 't') {
+                expectWord("true");
+                return true;
+            }
+            expectWord("false");
+            return false;
+        }
+
+        // Returns true (and consumes it) if the next value is null
+        bool readNull() {
+            if (peekNonWhitespace() != 'n') { return false; }
+            expectWord("null");
+            return true;
+        }
+
+        void skipValue() {
+            switch (peekNonWhitespace()) {
+                case '{':
+                    forEachMember([this](const std::string &) { skipValue(); });
+                    break;
+                case '[':
+                    forEachElement([this] { skipValue(); });
+                    break;
+                case '"':
+                    readString();
+                    break;
+                case 't':
+                case 'f':
+                    readBool();
+                    break;
+                case 'n':
+                    readNull();
+                    break;
+                default:
+                    readNumber();
+            }
+        }
+
+        // Anything but whitespace after the top-level value is an error
+        void expectEnd() {
+            skipWhitespace();
+            if (!input.isExhausted()) { fail("Unexpected data after the show"); }
+        }
+
+        // Reports progress, at most once per percent
+        void reportProgress() {
+            if (onProgress == nullptr || totalLength <= 0) { return; }
+            const auto fraction = static_cast<double>(input.getPosition()) / static_cast<double>(totalLength);
+            if (fraction - lastReportedProgress >= 0.01) {
+                lastReportedProgress = fraction;
+                onProgress(fraction);
+            }
+        }
+
+        [[noreturn]] void fail(const String &message) const {
+            throw ParseError{message + " (line " + String(line) + ")"};
+        }
+
+    private:
+        BufferedInputStream input;
+        const int64 totalLength;
+        const ShowJSON::ProgressCallback &onProgress;
+        double lastReportedProgress{0.0};
+        int line{1};
+        int depth{0};
+
+        struct DepthGuard {
+            explicit DepthGuard(JSONPullParser &parser): parser(parser) {
+                if (++parser.depth > maxDepth) { parser.fail("Nested too deeply"); }
+            }
+            ~DepthGuard() { parser.depth--; }
+            JSONPullParser &parser;
+        };
+
+        char peek() { return input.isExhausted() ? '\0' : static_cast<char>(input.peekByte()); }
+
+        char next() {
+            if (input.isExhausted()) { fail("Unexpected end of file"); }
+            const auto c = input.readByte();
+            if (c == '\n') { line++; }
+            return c;
+        }
+
+        void skipWhitespace() {
+            while (!input.isExhausted()) {
+                const auto c = peek();
+                if (c != ' ' && c != '\t' && c != '\r' && c != '\n') { return; }
+                next();
+            }
+        }
+
+        char peekNonWhitespace() {
+            skipWhitespace();
+            return peek();
+        }
+
+        char nextNonWhitespace() {
+            skipWhitespace();
+            return next();
+        }
+
+        void expect(char expected) {
+            if (nextNonWhitespace() != expected) { fail(String("Expected '") + expected + "'"); }
+        }
+
+        void expectWord(const char *word) {
+            for (auto *c = word; *c != '\0'; c++) {
+                if (next() != *c) { fail(String("Expected ") + word); }
+            }
+        }
+
+        uint32 readHex4() {
+            uint32 value = 0;
+            for (int i = 0; i < 4; i++) {
+                const auto digit = CharacterFunctions::getHexDigitValue(static_cast<juce_wchar>(next()));
+                if (digit < 0) { fail("Bad \\u escape"); }
+                value = (value << 4) | static_cast<uint32>(digit);
+            }
+            return value;
+        }
+
+        void readEscape(std::string &string) {
+            const auto c = next();
+            switch (c) {
+                case '"': string.push_back('"'); return;
+                case '\\': string.push_back('\\'); return;
+                case '/': string.push_back('/'); return;
+                case 'b': string.push_back('\b'); return;
+                case 'f': string.push_back('\f'); return;
+                case 'n': string.push_back('\n'); return;
+                case 'r': string.push_back('\r'); return;
+                case 't': string.push_back('\t'); return;
+                case 'u': break;
+                default: fail("Bad escape in string");
+            }
+            auto codePoint = readHex4();
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                // The high half of a surrogate pair; the low half must follow
+                if (next() != '\\' || next() != 'u') { fail("Unpaired surrogate in string"); }
+                const auto low = readHex4();
+                if (low < 0xDC00 || low > 0xDFFF) { fail("Unpaired surrogate in string"); }
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            }
+            char utf8[8];
+            const auto length = CharPointer_UTF8::getBytesRequiredFor(static_cast<juce_wchar>(codePoint));
+            CharPointer_UTF8(utf8).write(static_cast<juce_wchar>(codePoint));
+            string.append(utf8, length);
+        }
+    };
+
+
+    // An action's members, gathered as they're parsed (members can come in any order) and built at its closing brace.
+    struct ActionFields {
+        std::string id;
+        std::string type;
+        std::string address;
+        std::string templateID;
+        std::optional<ArgumentTemplateRef> argumentTemplate; // Only for templates written out in full
+        ValueStorer argument;
+        float fadeTime{0.f};
+        ValueStorer startValue;
+        ValueStorer endValue;
+    };
+
+
+    // {"int": 1}, {"float": 0.5}, {"string": "..."} or null
+    ValueStorer readValue(JSONPullParser &parser) {
+        ValueStorer value;
+        if (parser.readNull()) {
+            return value;
+        }
+        parser.forEachMember([&](const std::string &key) {
+            if (key == "int") {
+                value.changeStore(parser.readInt());
+            } else if (key == "float") {
+                value.changeStore(parser.readFloat());
+            } else if (key == "string") {
+                value.changeStore(parser.readString());
+            } else {
+                parser.fail("Unknown value type \"" + String(key) + "\"");
+            }
+        });
+        return value;
+    }
+
+
+    ArgumentTemplateRef readTemplate(JSONPullParser &parser) {
+        std::string kind, name, verboseName, description, defaultString;
+        std::vector<std::string> values;
+        int paramType = BLANK, unit = NONE, defaultInt = 0, intMin = 0, intMax = 0;
+        float defaultFloat = 0.f, floatMin = 0.f, floatMax = 0.f;
+        bool normalisedInverted = false;
+
+        parser.forEachMember([&](const std::string &key) {
+            if (key == "kind") { kind = parser.readString(); }
+            else if (key == "paramType") { paramType = indexOfName(paramTypeNames, parser.readString()); }
+            else if (key == "unit") { unit = indexOfName(unitNames, parser.readString()); }
+            else if (key == "name") { name = parser.readString(); }
+            else if (key == "verboseName") { verboseName = parser.readString(); }
+            else if (key == "description") { description = parser.readString(); }
+            else if (key == "defaultInt") { defaultInt = parser.readInt(); }
+            else if (key == "intMin") { intMin = parser.readInt(); }
+            else if (key == "intMax") { intMax = parser.readInt(); }
+            else if (key == "defaultFloat") { defaultFloat = parser.readFloat(); }
+            else if (key == "floatMin") { floatMin = parser.readFloat(); }
+            else if (key == "floatMax") { floatMax = parser.readFloat(); }
+            else if (key == "normalisedInverted") { normalisedInverted = parser.readBool(); }
+            else if (key == "defaultString") { defaultString = parser.readString(); }
+            else if (key == "values") { parser.forEachElement([&] { values.push_back(parser.readString()); }); }
+            else { parser.skipValue(); }
+        });
+
+        if (paramType < 0) { parser.fail("Unknown paramType"); }
+        if (unit < 0) { parser.fail("Unknown unit"); }
+        const auto units = static_cast<Units>(unit);
+        if (kind == "nonIter") {
+            return NonIter(name, verboseName, description, defaultInt, intMin, intMax, defaultFloat, floatMin, floatMax,
+                           defaultString, static_cast<ParamType>(paramType), units, normalisedInverted);
+        }
+        if (kind == "enum" || kind == "option") {
+            if (values.empty()) { parser.fail("A " + String(kind) + " template needs values"); }
+            if (kind == "enum") { return EnumParam(name, verboseName, description, values, units); }
+            return OptionParam(name, verboseName, description, values, units);
+        }
+        parser.fail("Unknown template kind \"" + String(kind) + "\"");
+    }
+
+
+    // Whether value can be sent with (or, for fades, faded by) the template
+    bool valueFitsTemplate(const ValueStorer &value, const ArgumentTemplateRef &argumentTemplate) {
+        if (const auto *nonIter = argumentTemplate.getNonIter()) {
+            switch (value._meta_PARAMTYPE) {
+                case INT: return nonIter->valueIsValid(value.intValue);
+                case _GENERIC_FLOAT: return nonIter->valueIsValid(value.floatValue);
+                case STRING: {
+                    const auto string = value.stringValue.toStdString();
+                    if (nonIter->_meta_PARAMTYPE == BITSET) {
+                        // Sent by parsing the string as binary, so it must be exactly intMax 0s and 1s
+                        return string.size() == static_cast<size_t>(nonIter->intMax) &&
+                               string.find_first_not_of("01") == std::string::npos;
+                    }
+                    return nonIter->valueIsValid(string);
+                }
+                default: return nonIter->_meta_PARAMTYPE == BLANK;
+            }
+        }
+        if (const auto *enumParam = argumentTemplate.getEnumParam()) {
+            return value._meta_PARAMTYPE == INT && enumParam->validIndex(value.intValue);
+        }
+        if (const auto *optionParam = argumentTemplate.getOptionParam()) {
+            return value._meta_PARAMTYPE == STRING &&
+                   std::find(optionParam->value.begin(), optionParam->value.end(),
+                             value.stringValue.toStdString()) != optionParam->value.end();
+        }
+        return false;
+    }
+
+
+    CueOSCAction buildAction(JSONPullParser &parser, ActionFields &fields) {
+        OSCAddressPattern address("/");
+        try {
+            address = OSCAddressPattern(fields.address);
+        } catch (const OSCFormatError &) {
+            parser.fail("Bad OSC address \"" + String(fields.address) + "\"");
+        }
+
+        // A template from the template table is only stored by ID, so it is checked against the table's entry
+        const XM32Template *tableTemplate = nullptr;
+        if (!fields.templateID.empty()) {
+            if (const auto found = ID_TO_TEMPLATE_MAP.find(fields.templateID); found != ID_TO_TEMPLATE_MAP.end()) {
+                tableTemplate = &found->second;
+            }
+        }
+        if (!fields.argumentTemplate.has_value()) {
+            if (tableTemplate == nullptr) {
+                parser.fail("Unknown template \"" + String(fields.templateID) + "\"");
+            }
+            fields.argumentTemplate = ArgumentTemplateRef(tableTemplate->getRawMessageArgument());
+        }
+        const auto &argumentTemplate = *fields.argumentTemplate;
+
+        if (fields.type == "command") {
+            if (fields.argument._meta_PARAMTYPE != BLANK && !valueFitsTemplate(fields.argument, argumentTemplate)) {
+                parser.fail("Argument doesn't fit the action's template");
+            }
+            return {address, argumentTemplate, fields.argument, fields.templateID, fields.id};
+        }
+        if (fields.type == "fade") {
+            if (argumentTemplate.getNonIter() == nullptr || (tableTemplate != nullptr && !tableTemplate->FADE_ENABLED)) {
+                parser.fail("The action's template can't be faded");
+            }
+            // Strings can't be faded (and FadeValue can't hold them)
+            if (fields.startValue._meta_PARAMTYPE == STRING || fields.endValue._meta_PARAMTYPE == STRING ||
+                !valueFitsTemplate(fields.startValue, argumentTemplate) ||
+                !valueFitsTemplate(fields.endValue, argumentTemplate)) {
+                parser.fail("Fade values don't fit the action's template");
+            }
+            if (!(fields.fadeTime >= 0.f) || std::isinf(fields.fadeTime)) {
+                parser.fail("Fade time must be a finite, non-negative number");
+            }
+            return {address, fields.fadeTime, argumentTemplate, fields.startValue, fields.endValue, fields.templateID,
+                    fields.id};
+        }
+        parser.fail("Unknown action type \"" + String(fields.type) + "\"");
+    }
+
+
+    CueOSCAction readAction(JSONPullParser &parser) {
+        ActionFields fields;
+        parser.forEachMember([&](const std::string &key) {
+            if (key == "id") { fields.id = parser.readString(); }
+            else if (key == "type") { fields.type = parser.readString(); }
+            else if (key == "address") { fields.address = parser.readString(); }
+            else if (key == "templateID") { fields.templateID = parser.readString(); }
+            else if (key == "template") { fields.argumentTemplate = readTemplate(parser); }
+            else if (key == "argument") { fields.argument = readValue(parser); }
+            else if (key == "fadeTime") { fields.fadeTime = parser.readFloat(); }
+            else if (key == "start") { fields.startValue = readValue(parser); }
+            else if (key == "end") { fields.endValue = readValue(parser); }
+            else { parser.skipValue(); }
+        });
+        return buildAction(parser, fields);
+    }
+
+
+    CurrentCueInfo readCue(JSONPullParser &parser) {
+        std::string id, name, description, internalID;
+        std::vector<CueOSCAction> actions;
+        parser.forEachMember([&](const std::string &key) {
+            if (key == "id") { id = parser.readString(); }
+            else if (key == "name") { name = parser.readString(); }
+            else if (key == "description") { description = parser.readString(); }
+            else if (key == "internalID") { internalID = parser.readString(); }
+            else if (key == "actions") {
+                parser.forEachElement([&] {
+                    actions.push_back(readAction(parser));
+                    parser.reportProgress();
+                });
+            } else { parser.skipValue(); }
+        });
+        return {String::fromUTF8(id.c_str()), String::fromUTF8(name.c_str()), String::fromUTF8(description.c_str()),
+                actions, internalID};
+    }
+
+
+    // Writes JSON, one cue and one action per line.
+    class JSONWriter {
+    public:
+        explicit JSONWriter(OutputStream &output): output(output) {}
+
+        void raw(const char *text) { output.write(text, std::strlen(text)); }
+
+        void string(const std::string &string) {
+            output.writeByte('"');
+            for (const auto c: string) {
+                switch (c) {
+                    case '"': raw("\\\""); break;
+                    case '\\': raw("\\\\"); break;
+                    case '\n': raw("\\n"); break;
+                    case '\r': raw("\\r"); break;
+                    case '\t': raw("\\t"); break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                            raw(escaped);
+                        } else {
+                            output.writeByte(c);
+                        }
+                }
+            }
+            output.writeByte('"');
+        }
+
+        void string(const String &string) { this->string(string.toStdString()); }
+
+        // Writes "key": , ready for the value
+        void key(const char *key) {
+            string(std::string(key));
+            raw(": ");
+        }
+
+        void number(int number) { raw(std::to_string(number).c_str()); }
+
+        // %.9g round-trips every float. JSON has no NaN or infinities, so those are written as the strings "NaN",
+        // "Infinity" and "-Infinity", which JSONPullParser::readFloat() reads back.
+        void number(float number) {
+            if (std::isnan(number)) {
+                raw("\"NaN\"");
+                return;
+            }
+            if (std::isinf(number)) {
+                raw(number > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+                return;
+            }
+            char digits[32];
+            std::snprintf(digits, sizeof(digits), "%.9g", static_cast<double>(number));
+            raw(digits);
+        }
+
+        void value(const ValueStorer &value) {
+            switch (value._meta_PARAMTYPE) {
+                case INT:
+                    raw("{\"int\": ");
+                    number(value.intValue);
+                    break;
+                case _GENERIC_FLOAT:
+                    raw("{\"float\": ");
+                    number(value.floatValue);
+                    break;
+                case STRING:
+                    raw("{\"string\": ");
+                    string(value.stringValue.toStdString());
+                    break;
+                default:
+                    raw("null");
+                    return;
+            }
+            raw("}");
+        }
+
+        template<typename Param>
+        void templateHeader(const char *kind, const Param &param) {
+            raw("{\"kind\": \"");
+            raw(kind);
+            raw("\", \"paramType\": \"");
+            raw(paramTypeNames[param._meta_PARAMTYPE]);
+            raw("\", \"unit\": \"");
+            raw(unitNames[param._meta_UNIT]);
+            raw("\", ");
+            key("name"); string(param.name); raw(", ");
+            key("verboseName"); string(param.verboseName); raw(", ");
+            key("description"); string(param.description);
+        }
+
+        void values(const std::vector<std::string> &values) {
+            raw(", \"values\": [");
+            for (size_t i = 0; i < values.size(); i++) {
+                if (i != 0) { raw(", "); }
+                string(values[i]);
+            }
+            raw("]}");
+        }
+
+        void argumentTemplate(const ArgumentTemplateRef &ref) {
+            if (const auto *nonIter = ref.getNonIter()) {
+                templateHeader("nonIter", *nonIter);
+                raw(", \"defaultInt\": "); number(nonIter->defaultIntValue);
+                raw(", \"intMin\": "); number(nonIter->intMin);
+                raw(", \"intMax\": "); number(nonIter->intMax);
+                raw(", \"defaultFloat\": "); number(nonIter->defaultFloatValue);
+                raw(", \"floatMin\": "); number(nonIter->floatMin);
+                raw(", \"floatMax\": "); number(nonIter->floatMax);
+                raw(", \"normalisedInverted\": "); raw(nonIter->normalisedInverted ? "true" : "false");
+                raw(", \"defaultString\": "); string(nonIter->defaultStringValue);
+                raw("}");
+            } else if (const auto *enumParam = ref.getEnumParam()) {
+                templateHeader("enum", *enumParam);
+                values(enumParam->value);
+            } else if (const auto *optionParam = ref.getOptionParam()) {
+                templateHeader("option", *optionParam);
+                values(optionParam->value);
+            }
+        }
+
+        void action(const CueOSCAction &action) {
+            raw("{\"id\": "); string(action.ID);
+            raw(action.oat == OAT_FADE ? ", \"type\": \"fade\"" : ", \"type\": \"command\"");
+            raw(", \"address\": "); string(action.oscAddress.toString());
+            if (!action.argumentTemplateID.empty()) {
+                raw(", \"templateID\": "); string(action.argumentTemplateID);
+            }
+            if (!action.argumentTemplate.isFromTable() || action.argumentTemplateID.empty()) {
+                raw(", \"template\": "); argumentTemplate(action.argumentTemplate);
+            }
+            if (action.oat == OAT_FADE) {
+                raw(", \"fadeTime\": "); number(action.fadeTime);
+                raw(", \"start\": "); value(action.startValue);
+                raw(", \"end\": "); value(action.endValue);
+            } else {
+                raw(", \"argument\": "); value(action.argument);
+            }
+            raw("}");
+        }
+
+        void cue(const CurrentCueInfo &cci) {
+            raw("    {\n      \"id\": "); string(cci.id);
+            raw(", \"name\": "); string(cci.name);
+            raw(", \"description\": "); string(cci.description);
+            raw(", \"internalID\": "); string(cci.getInternalID());
+            raw(",\n      \"actions\": [");
+            bool first = true;
+            for (const auto &cueAction: cci.actions) {
+                if (cueAction.oat == EXIT_THREAD) { continue; }
+                raw(first ? "\n        " : ",\n        ");
+                action(cueAction);
+                first = false;
+            }
+            raw(first ? "]\n    }" : "\n      ]\n    }");
+        }
+
+    private:
+        OutputStream &output;
+    };
+}
+
+
+Result ShowJSON::Reader::read() {
+    JSONPullParser parser(input, onProgress);
+    try {
+        bool sawFormat = false;
+        parser.forEachMember([&](const std::string &key) {
+            if (key == "format") {
+                if (parser.readString() != formatName) { parser.fail("Not a show file"); }
+                sawFormat = true;
+            } else if (key == "version") {
+                const auto fileVersion = parser.readInt();
+                if (fileVersion > version) { parser.fail("Show file is from a newer version (" + String(fileVersion) + ")"); }
+            } else if (key == "name") {
+                showName = String::fromUTF8(parser.readString().c_str());
+            } else if (key == "description") {
+                showDescription = String::fromUTF8(parser.readString().c_str());
+            } else if (key == "cues") {
+                if (!sawFormat) { parser.fail("Not a show file"); }
+                parser.forEachElement([&] {
+                    auto cci = readCue(parser);
+                    if (onCue != nullptr) { onCue(std::move(cci)); }
+                });
+            } else {
+                parser.skipValue();
+            }
+        });
+        parser.expectEnd();
+    } catch (const ParseError &error) {
+        return Result::fail(error.message);
+    }
+    if (onProgress != nullptr) { onProgress(1.0); }
+    return Result::ok();
+}
+
+
+Result ShowJSON::write(OutputStream &output, CurrentCueInfoVector &cciVector, const String &showName,
+                       const String &showDescription, const ProgressCallback &onProgress) {
+    JSONWriter writer(output);
+    writer.raw("{\n  \"format\": \""); writer.raw(formatName);
+    writer.raw("\", \"version\": "); writer.number(version);
+    writer.raw(",\n  \"name\": "); writer.string(showName);
+    writer.raw(",\n  \"description\": "); writer.string(showDescription);
+    writer.raw(",\n  \"cues\": [");
+    const auto size = cciVector.getSize();
+    for (size_t i = 0; i < size; i++) {
+        writer.raw(i == 0 ? "\n" : ",\n");
+        writer.cue(cciVector.getCurrentCueInfoByIndex(i));
+        if (onProgress != nullptr) { onProgress(static_cast<double>(i + 1) / static_cast<double>(size)); }
+    }
+    writer.raw(size == 0 ? "]\n}\n" : "\n  ]\n}\n");
+    output.flush();
+    return Result::ok();
+}
+
+
+Result ShowJSON::write(const File &destination, CurrentCueInfoVector &cciVector, const String &showName,
+                       const String &showDescription, const ProgressCallback &onProgress) {
+    TemporaryFile temporaryFile(destination);
+    {
+        FileOutputStream out(temporaryFile.getFile());
+        if (out.failedToOpen()) {
+            return out.getStatus();
+        }
+        write(out, cciVector, showName, showDescription, onProgress);
+        if (out.getStatus().failed()) {
+            return out.getStatus();
+        }
+    }
+    if (!temporaryFile.overwriteTargetFileWithTemporary()) {
+        return Result::fail("Couldn't replace " + destination.getFullPathName());
+    }
+    return Result::ok();
+}
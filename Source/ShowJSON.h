@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    ShowJSON.h
+    Created: 17 Oct 2026 2:41:05pm
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include "Helpers.h"
+
+
+/* The text show format: JSON meant to be kept in version control, so every cue and action is written on its own
+ * lines, in show order, with its persistent IDs. Actions using a template from the template table only store its ID;
+ * any other template is written out in full. A show looks like:
+ *
+ *   {
+ *     "format": "xm32show", "version": 1,
+ *     "name": "...", "description": "...",
+ *     "cues": [
+ *       {
+ *         "id": "S1", "name": "...", "description": "...", "internalID": "...",
+ *         "actions": [
+ *           {"id": "...", "type": "command", "address": "/ch/01/mix/on", "templateID": "...", "argument": {"int": 1}},
+ *           {"id": "...", "type": "fade", "address": "/ch/01/mix/fader", "template": {...}, "fadeTime": 1,
+ *            "start": {"float": -90}, "end": {"float": 0}}
+ *         ]
+ *       }
+ *     ]
+ *   }
+ *
+ * JSON has no NaN or infinities, so floats that aren't finite are written as the strings "NaN", "Infinity" and
+ * "-Infinity". No sendable value is ever one of those, but a template's range can be.
+ *
+ * Neither direction ever holds more than one action's worth of JSON: the reader parses straight from the stream,
+ * and the writer writes straight from the CurrentCueInfoVector.
+ */
+namespace ShowJSON {
+    constexpr int version = 1;
+
+    // Called with the fraction (0 to 1) of the show read or written so far
+    using ProgressCallback = std::function<void(double)>;
+
+
+    /* Parses a show from a stream, handing each cue to onCue as soon as its closing brace is read. Every action is
+     * checked against its template (and, when it names one, its XM32Template) as it's parsed, and the first invalid
+     * action fails the read. Unknown keys are skipped, so newer files with extra fields still load.
+     */
+    class Reader {
+    public:
+        explicit Reader(InputStream &input): input(input) {}
+
+        std::function<void(CurrentCueInfo &&)> onCue;
+        ProgressCallback onProgress;
+
+        // On failure, the message says where in the stream the error is. Cues already passed to onCue stay valid.
+        Result read();
+
+        // Only valid after a successful read()
+        [[nodiscard]] const String &getShowName() const { return showName; }
+        [[nodiscard]] const String &getShowDescription() const { return showDescription; }
+
+    private:
+        InputStream &input;
+        String showName;
+        String showDescription;
+    };
+
+
+    // Writes the show as JSON. Reports progress per cue.
+    Result write(OutputStream &output, CurrentCueInfoVector &cciVector, const String &showName,
+                 const String &showDescription, const ProgressCallback &onProgress = nullptr);
+
+    // Writes the show to destination, replacing it only once the whole show is written.
+    Result write(const File &destination, CurrentCueInfoVector &cciVector, const String &showName,
+                 const String &showDescription, const ProgressCallback &onProgress = nullptr);
+}
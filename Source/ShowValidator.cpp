@@ -0,0 +1,337 @@
+/*
+  ==============================================================================
+
+    ShowValidator.cpp
+    Created: 17 Oct 2026 8:14:27pm
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#include "ShowValidator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <unordered_map>
+
+
+namespace ShowValidator {
+    namespace {
+        // Cues checked per grain. Most cues have a handful of actions, so this is small enough to balance across cores
+        // but large enough that taking grains is a small fraction of the work.
+        constexpr size_t cuesPerGrain = 32;
+
+        String describeValue(const ValueStorer &value) {
+            switch (value._meta_PARAMTYPE) {
+                case INT: return String(value.intValue);
+                case _GENERIC_FLOAT: return String(value.floatValue);
+                case STRING: return "\"" + String(value.stringValue.toStdString()) + "\"";
+                default: return "nothing";
+            }
+        }
+    }
+
+
+    String checkValue(const ValueStorer &value, const ArgumentTemplateRef &argumentTemplate,
+                      ShowDiagnostic::Check &check) {
+        check = ShowDiagnostic::VALUE_TYPE;
+        if (const auto *nonIter = argumentTemplate.getNonIter()) {
+            switch (nonIter->_meta_PARAMTYPE) {
+                case INT:
+                    if (value._meta_PARAMTYPE != INT) { return "Expected a whole number, not " + describeValue(value); }
+                    if (!nonIter->valueIsValid(value.intValue)) {
+                        check = ShowDiagnostic::VALUE_RANGE;
+                        return describeValue(value) + " is outside " + String(nonIter->intMin) + " to " +
+                               String(nonIter->intMax);
+                    }
+                    return {};
+                case LINF:
+                case LOGF:
+                case LEVEL_161:
+                case LEVEL_1024:
+                    if (value._meta_PARAMTYPE != _GENERIC_FLOAT) { return "Expected a number, not " + describeValue(value); }
+                    if (!std::isfinite(value.floatValue) || !nonIter->valueIsValid(value.floatValue)) {
+                        check = ShowDiagnostic::VALUE_RANGE;
+                        return describeValue(value) + " is outside " + String(nonIter->floatMin) + " to " +
+                               String(nonIter->floatMax);
+                    }
+                    return {};
+                case STRING:
+                    if (value._meta_PARAMTYPE != STRING) { return "Expected text, not " + describeValue(value); }
+                    if (!nonIter->valueIsValid(value.stringValue.toStdString())) {
+                        check = ShowDiagnostic::STRING_LENGTH;
+                        return describeValue(value) + " isn't " + String(nonIter->intMin) + " to " +
+                               String(nonIter->intMax) + " characters long";
+                    }
+                    return {};
+                case BITSET: {
+                    // Sent by parsing the string as binary, so it must be exactly intMax 0s and 1s
+                    if (value._meta_PARAMTYPE != STRING) { return "Expected a bitset, not " + describeValue(value); }
+                    const auto bits = value.stringValue.toStdString();
+                    if (bits.size() != static_cast<size_t>(nonIter->intMax) ||
+                        bits.find_first_not_of("01") != std::string::npos) {
+                        check = ShowDiagnostic::BITSET_LENGTH;
+                        return describeValue(value) + " isn't " + String(nonIter->intMax) + " bits (0s and 1s)";
+                    }
+                    return {};
+                }
+                case BLANK:
+                    if (value._meta_PARAMTYPE != BLANK) { return "The template takes no argument"; }
+                    return {};
+                default:
+                    return "The template's type can't be sent";
+            }
+        }
+        if (const auto *enumParam = argumentTemplate.getEnumParam()) {
+            if (value._meta_PARAMTYPE != INT) { return "Expected an enum index, not " + describeValue(value); }
+            if (!enumParam->validIndex(value.intValue)) {
+                check = ShowDiagnostic::ENUM_INDEX;
+                return "Enum index " + describeValue(value) + " is outside 0 to " + String(
+                           static_cast<int>(enumParam->len) - 1);
+            }
+            return {};
+        }
+        if (const auto *optionParam = argumentTemplate.getOptionParam()) {
+            if (value._meta_PARAMTYPE != STRING) { return "Expected an option, not " + describeValue(value); }
+            if (std::find(optionParam->value.begin(), optionParam->value.end(), value.stringValue.toStdString()) ==
+                optionParam->value.end()) {
+                check = ShowDiagnostic::OPTION_VALUE;
+                return describeValue(value) + " isn't one of the template's options";
+            }
+            return {};
+        }
+        jassertfalse; // ArgumentTemplateRef always holds one of the above
+        return "Unknown template type";
+    }
+
+
+    String checkPath(const String &address, const ArgumentEmbeddedPath &path) {
+        // The reverse of OSCDeviceSender::fillInArgumentsOfEmbeddedPath(): literal segments must match exactly, and each
+        // argument runs up to the next literal segment (or the end of the address).
+        const auto text = address.toStdString();
+        size_t position = 0;
+        int argumentNumber = 0;
+        for (size_t segment = 0; segment < path.size(); segment++) {
+            if (const auto *literal = std::get_if<std::string>(&path[segment])) {
+                if (text.compare(position, literal->size(), *literal) != 0) {
+                    return "Expected \"" + String(*literal) + "\" at character " + String(static_cast<int>(position) + 1);
+                }
+                position += literal->size();
+                continue;
+            }
+
+            const auto *argument = std::get_if<NonIter>(&path[segment]);
+            if (argument == nullptr) {
+                jassertfalse; // ArgumentEmbeddedPath is only ever strings and NonIters
+                return "Unknown path segment type";
+            }
+            argumentNumber++;
+            size_t end = text.size();
+            if (segment + 1 < path.size()) {
+                if (const auto *next = std::get_if<std::string>(&path[segment + 1])) {
+                    end = text.find(*next, position);
+                    if (end == std::string::npos) {
+                        return "Expected \"" + String(*next) + "\" after path argument " + String(argumentNumber);
+                    }
+                }
+            }
+            const auto value = text.substr(position, end - position);
+            switch (argument->_meta_PARAMTYPE) {
+                case INT: {
+                    const auto digits = value.find_first_not_of("0123456789", !value.empty() && value[0] == '-' ? 1 : 0);
+                    if (value.empty() || value == "-" || digits != std::string::npos) {
+                        return "Path argument " + String(argumentNumber) + " (\"" + String(value) +
+                               "\") isn't a whole number";
+                    }
+                    const auto number = std::strtoll(value.c_str(), nullptr, 10);
+                    if (number < argument->intMin || number > argument->intMax) {
+                        return "Path argument " + String(argumentNumber) + " (" + String(value) + ") is outside " +
+                               String(argument->intMin) + " to " + String(argument->intMax);
+                    }
+                    break;
+                }
+                case STRING:
+                    if (value.length() < static_cast<size_t>(std::max(0, argument->intMin)) ||
+                        value.length() > static_cast<size_t>(std::max(0, argument->intMax))) {
+                        return "Path argument " + String(argumentNumber) + " (\"" + String(value) + "\") isn't " +
+                               String(argument->intMin) + " to " + String(argument->intMax) + " characters long";
+                    }
+                    break;
+                default:
+                    return "Path argument " + String(argumentNumber) + " has a type that can't be in a path";
+            }
+            position = end;
+        }
+        if (position != text.size()) {
+            return "\"" + String(text.substr(position)) + "\" is past the end of the template's path (" +
+                   String(argumentNumber) + " path arguments)";
+        }
+        return {};
+    }
+
+
+    namespace {
+        /* Does the checks of validateAction() given what is already known about the action's template. tableTemplate
+         * is the template table's entry for action.argumentTemplateID (nullptr if it has none, or an unknown one), and
+         * pathProblem is checkPath() of the address against that entry's path.
+         */
+        void validateAgainst(const CueOSCAction &action, const XM32Template *tableTemplate, bool unknownTemplate,
+                             const String &pathProblem, size_t cueIndex, size_t actionIndex, CueHandle cueHandle,
+                             std::vector<ShowDiagnostic> &diagnostics) {
+            const auto add = [&](ShowDiagnostic::Severity severity, ShowDiagnostic::Check check, const String &message) {
+                diagnostics.push_back({severity, check, cueIndex, actionIndex, cueHandle, action.handle, message});
+            };
+
+            if (unknownTemplate) {
+                add(ShowDiagnostic::WARNING, ShowDiagnostic::UNKNOWN_TEMPLATE,
+                    "Template \"" + String(action.argumentTemplateID) + "\" isn't in the template table");
+            }
+
+            ShowDiagnostic::Check check;
+            if (action.oat == OAT_COMMAND) {
+                if (const auto message = checkValue(action.argument, action.argumentTemplate, check);
+                    message.isNotEmpty()) {
+                    add(ShowDiagnostic::ERROR, check, message);
+                }
+            } else if (action.oat == OAT_FADE) {
+                const auto *nonIter = action.argumentTemplate.getNonIter();
+                if (nonIter == nullptr) {
+                    add(ShowDiagnostic::ERROR, ShowDiagnostic::FADE_NOT_ENABLED, "Only NonIter templates can be faded");
+                } else if (tableTemplate != nullptr
+                               ? !tableTemplate->FADE_ENABLED
+                               : DEFAULT_FADING_ENABLED.count(nonIter->_meta_PARAMTYPE) == 0) {
+                    add(ShowDiagnostic::ERROR, ShowDiagnostic::FADE_NOT_ENABLED,
+                        "\"" + String(nonIter->verboseName) + "\" can't be faded");
+                } else {
+                    if (const auto message = checkValue(action.startValue, action.argumentTemplate, check);
+                        message.isNotEmpty()) {
+                        add(ShowDiagnostic::ERROR, check, "Start value: " + message);
+                    }
+                    if (const auto message = checkValue(action.endValue, action.argumentTemplate, check);
+                        message.isNotEmpty()) {
+                        add(ShowDiagnostic::ERROR, check, "End value: " + message);
+                    }
+                }
+                if (!std::isfinite(action.fadeTime) || action.fadeTime < 0.f) {
+                    add(ShowDiagnostic::ERROR, ShowDiagnostic::FADE_TIME,
+                        "Fade time " + String(action.fadeTime) + "s isn't a time");
+                }
+            }
+
+            if (tableTemplate != nullptr && pathProblem.isNotEmpty()) {
+                add(ShowDiagnostic::ERROR, ShowDiagnostic::PATH,
+                    action.oscAddress.toString() + " doesn't fit " + String(tableTemplate->NAME) + ": " + pathProblem);
+            }
+        }
+    }
+
+
+    void validateAction(const CueOSCAction &action, size_t cueIndex, size_t actionIndex, CueHandle cueHandle,
+                        std::vector<ShowDiagnostic> &diagnostics) {
+        // Only templates from the table have a path and a FADE_ENABLED to check against
+        const XM32Template *tableTemplate = nullptr;
+        bool unknownTemplate = false;
+        if (!action.argumentTemplateID.empty()) {
+            if (const auto found = ID_TO_TEMPLATE_MAP.find(action.argumentTemplateID);
+                found != ID_TO_TEMPLATE_MAP.end()) {
+                tableTemplate = &found->second;
+            } else {
+                unknownTemplate = true;
+            }
+        }
+        const auto pathProblem = tableTemplate != nullptr
+                                     ? checkPath(action.oscAddress.toString(), tableTemplate->PATH)
+                                     : String();
+        validateAgainst(action, tableTemplate, unknownTemplate, pathProblem, cueIndex, actionIndex, cueHandle,
+                        diagnostics);
+    }
+
+
+    std::vector<ShowDiagnostic> validate(CurrentCueInfoVector &cciVector) {
+        // Looking a cue up walks the order tree, so it's done once here rather than by every worker. Nothing can edit
+        // the show while the message thread is blocked here, so the pointers stay valid.
+        std::vector<const CurrentCueInfo *> ccis;
+        ccis.reserve(cciVector.getSize());
+        for (size_t index = 0; index < cciVector.getSize(); index++) {
+            ccis.push_back(&cciVector.getCurrentCueInfoByIndex(index));
+        }
+
+        // A show uses a few templates on a few hundred addresses over and over. So each template is looked up in the
+        // table once, and each address is checked against each template's path once, by scanning the template and
+        // address columns rather than every action.
+        const auto &columns = cciVector.getActionColumns();
+        std::vector<const XM32Template *> tableTemplates(columns.getTemplateCount() + 1, nullptr);
+        for (uint32 id = 1; id <= columns.getTemplateCount(); id++) {
+            if (const auto found = ID_TO_TEMPLATE_MAP.find(columns.getTemplateName(id));
+                found != ID_TO_TEMPLATE_MAP.end()) {
+                tableTemplates[id] = &found->second;
+            }
+        }
+        const auto &templateIDs = columns.getTemplateIDs();
+        const auto &addresses = columns.getAddresses();
+        const String noProblem;
+        std::unordered_map<uint64, String> pathProblems; // Keyed by address ID in the top half, template ID below
+        std::vector<const String *> pathProblemOfAction(columns.size(), &noProblem); // Points into pathProblems
+        for (size_t column = 0; column < columns.size(); column++) {
+            if (const auto *tableTemplate = tableTemplates[templateIDs[column]]) {
+                const auto key = static_cast<uint64>(addresses[column].getID()) << 32 | templateIDs[column];
+                auto found = pathProblems.find(key);
+                if (found == pathProblems.end()) {
+                    found = pathProblems.emplace(key, checkPath(addresses[column].toString(), tableTemplate->PATH)).first;
+                }
+                pathProblemOfAction[column] = &found->second;
+            }
+        }
+
+        const auto workers = parallelForWorkerCount(ccis.size(), cuesPerGrain);
+        std::vector<std::vector<ShowDiagnostic>> workerDiagnostics(workers);
+        parallelFor(ccis.size(), cuesPerGrain, workers, [&](size_t cueIndex, size_t worker) {
+            const auto &cci = *ccis[cueIndex];
+            if (cci.isInvalid()) {
+                return;
+            }
+            const auto range = columns.getCueRange(cueIndex);
+            jassert(range.count == cci.actions.size()); // Columns are out of date
+            for (size_t actionIndex = 0; actionIndex < range.count; actionIndex++) {
+                const auto column = range.first + actionIndex;
+                const auto templateID = templateIDs[column];
+                const auto *tableTemplate = tableTemplates[templateID];
+                validateAgainst(cci.actions[actionIndex], tableTemplate,
+                                templateID != ActionColumns::noTemplate && tableTemplate == nullptr,
+                                *pathProblemOfAction[column], cueIndex, actionIndex, cci.getHandle(),
+                                workerDiagnostics[worker]);
+            }
+        });
+
+        // Workers finish cues out of order (they steal from each other), so put them back in show order. Each action's
+        // diagnostics come from one worker, in order, so a stable sort keeps them that way.
+        std::vector<ShowDiagnostic> diagnostics;
+        for (auto &fromWorker: workerDiagnostics) {
+            diagnostics.insert(diagnostics.end(), std::make_move_iterator(fromWorker.begin()),
+                               std::make_move_iterator(fromWorker.end()));
+        }
+        std::stable_sort(diagnostics.begin(), diagnostics.end(), [](const ShowDiagnostic &a, const ShowDiagnostic &b) {
+            return a.cueIndex != b.cueIndex ? a.cueIndex < b.cueIndex : a.actionIndex < b.actionIndex;
+        });
+        return diagnostics;
+    }
+
+
+    String summarise(const std::vector<ShowDiagnostic> &diagnostics, size_t maxListed) {
+        const auto errors = static_cast<int64>(std::count_if(
+            diagnostics.begin(), diagnostics.end(),
+            [](const ShowDiagnostic &diagnostic) { return diagnostic.severity == ShowDiagnostic::ERROR; }));
+        const auto warnings = static_cast<int64>(diagnostics.size()) - errors;
+        String summary = String(errors) + (errors == 1 ? " error" : " errors") + " and " + String(warnings) +
+                         (warnings == 1 ? " warning" : " warnings") + " found.\n";
+        for (size_t i = 0; i < std::min(maxListed, diagnostics.size()); i++) {
+            const auto &diagnostic = diagnostics[i];
+            summary << "\nCue " << static_cast<int64>(diagnostic.cueIndex + 1) << ", action "
+                    << static_cast<int64>(diagnostic.actionIndex + 1) << ": " << diagnostic.message;
+        }
+        if (diagnostics.size() > maxListed) {
+            summary << "\n...and " << static_cast<int64>(diagnostics.size() - maxListed) << " more.";
+        }
+        return summary;
+    }
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    ShowValidator.h
+    Created: 17 Oct 2026 8:14:27pm
+    Author:  anony
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Helpers.h"
+
+
+// One problem found with an action
+struct ShowDiagnostic {
+    enum Severity {
+        WARNING, // Sendable, but not everything about the action could be checked
+        ERROR // The action would send a bad message, or couldn't be sent at all
+    };
+
+    enum Check {
+        UNKNOWN_TEMPLATE, // argumentTemplateID isn't in the template table, so the path and fade can't be checked
+        VALUE_TYPE, // The value is stored as the wrong type for its template
+        VALUE_RANGE, // A number outside the template's min and max
+        ENUM_INDEX, // An enum index past the last enumerator
+        OPTION_VALUE, // Not one of an option template's values
+        STRING_LENGTH, // A string shorter or longer than the template allows
+        BITSET_LENGTH, // A bitset with the wrong number of bits, or a char other than 0 or 1
+        PATH, // The address doesn't fit its template's path, or has the wrong number of path arguments
+        FADE_NOT_ENABLED, // A fade of a template that can't be faded
+        FADE_TIME // A negative or non-finite fade time
+    };
+
+    Severity severity;
+    Check check;
+    size_t cueIndex;
+    size_t actionIndex; // Index in the cue's actions
+    CueHandle cueHandle;
+    ActionHandle actionHandle;
+    String message;
+};
+
+
+/* Checks every action in a show against its template before it's sent: values against the template's range, enum,
+ * options, string length or bitset length, the address against the template table's path for it (including the number
+ * of path arguments), and fades against the table's FADE_ENABLED.
+ * Cues are spread across every core (see parallelFor() in modules.h), so a show of thousands of cues takes milliseconds.
+ * Template lookups and path checks are done once per template, and per address and template, from the show's
+ * ActionColumns rather than once per action.
+ */
+namespace ShowValidator {
+    // Empty if value can be sent with (or, for fades, faded by) argumentTemplate. Otherwise, why it can't. Sets check
+    // to the kind of problem.
+    String checkValue(const ValueStorer &value, const ArgumentTemplateRef &argumentTemplate,
+                      ShowDiagnostic::Check &check);
+
+    // Empty if address can be built from the template path. Otherwise, why it can't.
+    String checkPath(const String &address, const ArgumentEmbeddedPath &path);
+
+    // Appends every problem with action to diagnostics.
+    void validateAction(const CueOSCAction &action, size_t cueIndex, size_t actionIndex, CueHandle cueHandle,
+                        std::vector<ShowDiagnostic> &diagnostics);
+
+    // Checks every action of every cue. Diagnostics are in show order. Call from the message thread (like any other
+    // read of cciVector), which is blocked until the check is done.
+    std::vector<ShowDiagnostic> validate(CurrentCueInfoVector &cciVector);
+
+    // A summary for showing the user: the counts, then the first maxListed diagnostics, one per line.
+    String summarise(const std::vector<ShowDiagnostic> &diagnostics, size_t maxListed = 10);
+}
@@ -4,7 +4,15 @@
 
 // ReSharper disable CppDFANotInitializedField
 #pragma once
+#include <array>
+#include <atomic>
 #include <bitset>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <utility> // For std::move
 
 #include "modules.h"
@@ -387,21 +395,118 @@ enum ParamType {
 
 
 
+// Strings too long to keep inline in a CompactString. Each distinct string is stored once and is never removed or
+// changed, so an index into the pool never dangles - but the pool grows with every distinct long string for the rest of
+// the run, with no limit besides its capacity (1M strings). Strings live in a ChunkedArray, so they never move once
+// stored and get() doesn't lock: only intern() takes the mutex. Thread safe.
+class CompactStringPool {
+public:
+    CompactStringPool() = default;
+    CompactStringPool(const CompactStringPool &) = delete;
+    CompactStringPool &operator=(const CompactStringPool &) = delete;
+
+    // Throws std::length_error if the pool is full
+    uint32_t intern(const std::string &string) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto found = lookup.find(string);
+        if (found != lookup.end()) {
+            return found->second;
+        }
+        const auto index = count.load(std::memory_order_relaxed);
+        auto *stored = strings.claim(index);
+        if (stored == nullptr) {
+            throw std::length_error("CompactStringPool is full");
+        }
+        *stored = string;
+        lookup.emplace(*stored, static_cast<uint32_t>(index));
+        count.store(index + 1, std::memory_order_release); // Publishes the string to get()
+        return static_cast<uint32_t>(index);
+    }
+
+    // Lock-free. The returned reference stays valid for the pool's lifetime. Expects an index returned by intern().
+    const std::string &get(uint32_t index) const {
+        jassert(index < count.load(std::memory_order_acquire)); // Not an index from intern()
+        return *strings.find(index);
+    }
+
+    [[nodiscard]] size_t size() const { return count.load(std::memory_order_acquire); }
+
+private:
+    ChunkedArray<std::string> strings; // Each is written once, before count is moved past it
+    std::atomic<size_t> count{0};
+    std::mutex mutex; // Only taken by intern()
+    std::unordered_map<std::string_view, uint32_t> lookup; // Views of the stored strings, which never move
+};
+
+inline CompactStringPool compactStringPool;
+
+
+// The string of a ValueStorer, in 12 trivially copyable bytes. Strings of up to 12 chars (i.e., every X32 name) are
+// kept inline, NUL padded. Longer strings (or any with a NUL in them) are kept in compactStringPool, and chars instead
+// holds a NUL, pooledMarker, two bytes of padding and the string's pool index.
+struct CompactString {
+    static constexpr size_t inlineCapacity = 12;
+
+    char chars[inlineCapacity];
+
+    static CompactString from(const std::string &string) {
+        CompactString compact{};
+        if (string.size() <= inlineCapacity && string.find('\0') == std::string::npos) {
+            std::memcpy(compact.chars, string.data(), string.size());
+        } else {
+            const uint32_t index = compactStringPool.intern(string);
+            compact.chars[1] = pooledMarker;
+            std::memcpy(compact.chars + 4, &index, sizeof(index));
+        }
+        return compact;
+    }
+
+    [[nodiscard]] std::string toStdString() const {
+        return isPooled() ? compactStringPool.get(getPoolIndex()) : std::string(chars, inlineSize());
+    }
+
+    [[nodiscard]] size_t size() const { return isPooled() ? compactStringPool.get(getPoolIndex()).size() : inlineSize(); }
+    [[nodiscard]] size_t length() const { return size(); }
+    [[nodiscard]] bool empty() const { return chars[0] == '\0' && !isPooled(); }
+
+private:
+    static constexpr char pooledMarker = 1;
+
+    // An inline string never starts with a NUL unless it is empty, in which case every char is a NUL
+    [[nodiscard]] bool isPooled() const { return chars[0] == '\0' && chars[1] == pooledMarker; }
+
+    [[nodiscard]] size_t inlineSize() const {
+        size_t size = 0;
+        while (size < inlineCapacity && chars[size] != '\0') { size++; }
+        return size;
+    }
+
+    [[nodiscard]] uint32_t getPoolIndex() const {
+        uint32_t index;
+        std::memcpy(&index, chars + 4, sizeof(index));
+        return index;
+    }
+};
+
+
 // TODO: Considering support for BLOB (binary)?
+// Only the member matching _meta_PARAMTYPE is live; the others share its storage. 16 bytes and trivially copyable.
 struct ValueStorer {
-    // When Enum or Int:
-    int intValue {};
-    // When Float or Level:
-    float floatValue {};
-    // When String, Bitset or Option
-    std::string stringValue {};
+    union {
+        // When Enum or Int:
+        int intValue;
+        // When Float or Level:
+        float floatValue;
+        // When String, Bitset or Option
+        CompactString stringValue;
+    };
 
     ParamType _meta_PARAMTYPE;
 
-    ValueStorer(int intValue): intValue(intValue), _meta_PARAMTYPE(INT) {};
-    ValueStorer(float floatValue): floatValue(floatValue), _meta_PARAMTYPE(_GENERIC_FLOAT) {};
-    ValueStorer(const std::string &stringValue): stringValue(stringValue), _meta_PARAMTYPE(STRING) {};
-    ValueStorer(): _meta_PARAMTYPE(BLANK) {}; // Used for NonIter, acting as nullptr-equivalent for OSCMessageArguments
+    constexpr ValueStorer(int intValue): intValue(intValue), _meta_PARAMTYPE(INT) {};
+    constexpr ValueStorer(float floatValue): floatValue(floatValue), _meta_PARAMTYPE(_GENERIC_FLOAT) {};
+    ValueStorer(const std::string &stringValue): stringValue(CompactString::from(stringValue)), _meta_PARAMTYPE(STRING) {};
+    constexpr ValueStorer(): intValue(0), _meta_PARAMTYPE(BLANK) {}; // Used for NonIter, acting as nullptr-equivalent for OSCMessageArguments
 
     void changeStore(int newIntValue) {
         intValue = newIntValue;
@@ -412,27 +517,24 @@ struct ValueStorer {
         _meta_PARAMTYPE = _GENERIC_FLOAT;
     }
     void changeStore(const std::string &newStringValue) {
-        stringValue = newStringValue;
+        stringValue = CompactString::from(newStringValue);
         _meta_PARAMTYPE = STRING;
     }
 
     void changeStore(const ValueStorer& other) {
-        intValue = other.intValue;
-        floatValue = other.floatValue;
-        stringValue = other.stringValue;
-        _meta_PARAMTYPE = other._meta_PARAMTYPE;
+        *this = other;
     }
 
     // Clears the store to the value corresponding to if a blank constructor was used. BUT THIS ALSO MEANS THE PARAMTYPE
     // WILL CHANGE TO BLANK!
     void clearStore() {
-        intValue = 0;
-        floatValue = 0.f;
-        stringValue = "";
-        _meta_PARAMTYPE = BLANK;
+        *this = ValueStorer();
     }
 };
 
+static_assert(sizeof(ValueStorer) == 16, "ValueStorer should stay 16 bytes");
+static_assert(std::is_trivially_copyable<ValueStorer>::value, "ValueStorer should stay trivially copyable");
+
 
 // Ok, this originally used std::variant... but turns out it's slow as f*ck.
 // So this is a rare case where it makes sense to sacrifice the ridiculous amount of memory for multiple structs.
@@ -309,6 +309,223 @@ public:
 #endif
 
 
+#ifndef MPSC_RING_QUEUE
+#define MPSC_RING_QUEUE
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+// Multi-producer, single-consumer queue. Based on Dmitry Vyukov's bounded MPMC queue: each cell carries a sequence
+// number, so producers only contend on one atomic increment and neither side ever takes a lock on the fast path. The
+// consumer can block in popWait(); producers only touch the mutex when the consumer is actually asleep.
+// Never drops an element: when the ring is full, pushes spill into a mutex-guarded overflow list, and keep doing so
+// (to stay in order) until the consumer has drained it. The ring only sets how much fits before pushes take a lock.
+// Spilling sets the top bit of enqueuePos, so no push can reserve a ring cell once anything has spilled. The consumer
+// takes the spilled elements only once every cell reserved before the spill is taken, so each producer's elements
+// come out in the order it pushed them.
+template<typename T>
+class MPSCRingQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit MPSCRingQueue(size_t capacity = 1024) {
+        size_t size = 2;
+        while (size < capacity) { size <<= 1; }
+        mask = size - 1;
+        cells = std::vector<Cell>(size);
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Pushes an element to the queue. Safe to call from any thread.
+    void push(T item) {
+        Cell *cell = nullptr;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while ((pos & spillingBit) == 0) {
+            Cell &candidate = cells[pos & mask];
+            const size_t seq = candidate.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell = &candidate;
+                    break;
+                }
+            } else if (diff < 0) {
+                break; // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        if (cell != nullptr) {
+            cell->item.emplace(std::move(item));
+            cell->sequence.store(pos + 1, std::memory_order_release);
+        } else {
+            const std::lock_guard<std::mutex> lock(overflowMutex);
+            startSpilling();
+            overflow.push_back(std::move(item));
+        }
+        wakeConsumerIfWaiting();
+    }
+
+    // Pushes every element in [first, last) as one batch: the consumer sees either none or all of them, never part of
+    // the batch. Safe to call from any thread. A batch which doesn't fit in the ring is spilled whole.
+    template<typename Iterator>
+    void pushBatch(Iterator first, Iterator last) {
+        const auto count = static_cast<size_t>(std::distance(first, last));
+        if (count == 0) { return; }
+
+        bool reserved = false;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (count <= mask + 1 && (pos & spillingBit) == 0) {
+            // The consumer frees cells in order, so if the last cell of the batch is free, so are the rest
+            const size_t seq = cells[(pos + count - 1) & mask].sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + count - 1);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    reserved = true;
+                    break;
+                }
+            } else if (diff < 0) {
+                break; // Not enough room
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        if (!reserved) {
+            {
+                // Added under the lock in one go, so the consumer still sees all of the batch or none of it
+                const std::lock_guard<std::mutex> lock(overflowMutex);
+                startSpilling();
+                overflow.insert(overflow.end(), first, last);
+            }
+            wakeConsumerIfWaiting(); // Not under overflowMutex - popWait() takes it while holding wakeMutex
+            return;
+        }
+
+        for (size_t i = 0; first != last; ++first, ++i) {
+            cells[(pos + i) & mask].item.emplace(*first);
+        }
+        // Publish back to front. The consumer can't pass the first cell until it is published, and by then every
+        // other cell in the batch already is.
+        for (size_t i = count; i-- > 0;) {
+            cells[(pos + i) & mask].sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        wakeConsumerIfWaiting();
+    }
+
+    // Pops an element off the queue without blocking. Must only be called from the consumer thread.
+    std::optional<T> tryPop() {
+        Cell &cell = cells[dequeuePos & mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(dequeuePos + 1) < 0) {
+            if ((enqueuePos.load(std::memory_order_acquire) & spillingBit) == 0) {
+                return std::nullopt; // Empty, or the next cell is still being published (its producer wakes us)
+            }
+            const std::lock_guard<std::mutex> lock(overflowMutex);
+            if (dequeuePos != ringEndAtSpill) {
+                // Cells reserved before the spill are still being published. They were pushed first, so they go first.
+                return std::nullopt;
+            }
+            std::optional<T> item{std::move(overflow.front())};
+            overflow.pop_front();
+            if (overflow.empty()) {
+                // Back to the ring for the next push
+                enqueuePos.fetch_and(~spillingBit, std::memory_order_acq_rel);
+            }
+            return item;
+        }
+        std::optional<T> item = std::move(cell.item);
+        cell.item.reset();
+        cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        return item;
+    }
+
+    // Pops an element off the queue, waiting up to timeout for one to arrive. Must only be called from the consumer
+    // thread. Returns std::nullopt on timeout, or if interruptWait() was called.
+    std::optional<T> popWait(std::chrono::milliseconds timeout) {
+        if (auto item = tryPop()) { return item; }
+        if (interruptRequested.exchange(false)) { return std::nullopt; }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        consumerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::optional<T> item;
+        wakeCondition.wait_for(lock, timeout, [this, &item] {
+            if (auto popped = tryPop()) {
+                item.emplace(std::move(*popped)); // Emplaced, as T need not be assignable
+                return true;
+            }
+            return interruptRequested.exchange(false);
+        });
+        consumerWaiting.store(false, std::memory_order_relaxed);
+        return item;
+    }
+
+    // Makes the consumer's current (or next) popWait() return straight away, even if nothing was pushed. Lets
+    // another source of work wake the consumer. Safe to call from any thread.
+    void interruptWait() {
+        interruptRequested.store(true);
+        wakeConsumerIfWaiting();
+    }
+
+    // Approximate when called from a producer thread.
+    bool empty() const {
+        const Cell &cell = cells[dequeuePos & mask];
+        return cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1 &&
+               (enqueuePos.load(std::memory_order_acquire) & spillingBit) == 0;
+    }
+
+private:
+    static constexpr size_t spillingBit = ~(~size_t{0} >> 1); // In enqueuePos. Set while overflow isn't empty.
+
+    // Stops pushes reserving ring cells, and notes where the ring ends. Expects overflowMutex to be held.
+    void startSpilling() {
+        const auto pos = enqueuePos.fetch_or(spillingBit, std::memory_order_acq_rel);
+        if ((pos & spillingBit) == 0) {
+            ringEndAtSpill = pos;
+        }
+    }
+
+    void wakeConsumerIfWaiting() {
+        // Only take the mutex if the consumer is (about to be) asleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+        }
+    }
+
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        std::optional<T> item;
+
+        Cell() = default;
+        // Only needed so cells can live in a std::vector. Never called once the queue is in use.
+        Cell(Cell &&other) noexcept: sequence(other.sequence.load()), item(std::move(other.item)) {}
+    };
+
+    std::vector<Cell> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0}; // The top bit is spillingBit
+    alignas(64) size_t dequeuePos{0}; // Only touched by the consumer
+
+    // Elements pushed while the ring was full (or while anything was already spilled). Taken once the ring is empty.
+    std::deque<T> overflow;
+    std::mutex overflowMutex;
+    size_t ringEndAtSpill{0}; // enqueuePos when spilling started. Guarded by overflowMutex.
+
+    std::atomic<bool> consumerWaiting{false};
+    std::atomic<bool> interruptRequested{false};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+};
+#endif
+
+
 #ifndef ROUND
 #define ROUND
 
@@ -458,6 +675,422 @@ private:
 };
 #endif
 
+
+#ifndef CHUNKED_ARRAY
+#define CHUNKED_ARRAY
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/* A lazily allocated array of up to chunkSize * maxChunks elements which any thread can read without locking. Elements
+ * are stored in fixed-size chunks that are allocated the first time one of their elements is claimed and then never
+ * move or get freed until the array is destroyed, so a T& stays valid for the array's lifetime. T must be default
+ * constructible. The array only guards its chunks: its users synchronise access to the elements themselves.
+ */
+template<typename T, size_t chunkSize = 256, size_t maxChunks = 4096>
+class ChunkedArray {
+public:
+    static constexpr size_t capacity = chunkSize * maxChunks;
+
+    ChunkedArray() = default;
+    ChunkedArray(const ChunkedArray &) = delete;
+    ChunkedArray &operator=(const ChunkedArray &) = delete;
+
+    ~ChunkedArray() {
+        for (auto &chunk: chunks) {
+            delete chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Returns the element at index, allocating its chunk if needed. Returns nullptr only if index >= capacity.
+    T *claim(size_t index) {
+        const auto chunkIndex = index / chunkSize;
+        if (chunkIndex >= maxChunks) {
+            return nullptr;
+        }
+        auto *chunk = chunks[chunkIndex].load(std::memory_order_acquire);
+        if (chunk == nullptr) {
+            auto *fresh = new Chunk();
+            if (chunks[chunkIndex].compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel)) {
+                chunk = fresh;
+            } else {
+                delete fresh; // Another thread got there first; chunk now holds theirs
+            }
+        }
+        return &chunk->elements[index % chunkSize];
+    }
+
+    // Returns the element at index, or nullptr if its chunk has never been claimed. Never allocates.
+    T *find(size_t index) const {
+        const auto chunkIndex = index / chunkSize;
+        if (chunkIndex >= maxChunks) {
+            return nullptr;
+        }
+        auto *chunk = chunks[chunkIndex].load(std::memory_order_acquire);
+        return chunk == nullptr ? nullptr : &chunk->elements[index % chunkSize];
+    }
+
+private:
+    struct Chunk {
+        T elements[chunkSize];
+    };
+
+    std::array<std::atomic<Chunk *>, maxChunks> chunks{};
+};
+#endif
+
+
+#ifndef RUNTIME_HANDLE
+#define RUNTIME_HANDLE
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Compact identity for objects at runtime. The low 32 bits are a slot and the high 32 bits that slot's generation, so
+// a handle kept after its slot was released and reused never equals the new occupant's. The null handle (0) is never
+// allocated. Handles are only unique within one run of the app - persist UUIDs instead.
+struct RuntimeHandle {
+    uint64_t value{0};
+
+    [[nodiscard]] uint32_t getSlot() const { return static_cast<uint32_t>(value); }
+    [[nodiscard]] uint32_t getGeneration() const { return static_cast<uint32_t>(value >> 32); }
+    [[nodiscard]] bool isNull() const { return value == 0; }
+
+    bool operator==(const RuntimeHandle &other) const { return value == other.value; }
+    bool operator!=(const RuntimeHandle &other) const { return value != other.value; }
+    bool operator<(const RuntimeHandle &other) const { return value < other.value; }
+};
+
+namespace std {
+template<>
+struct hash<RuntimeHandle> {
+    size_t operator()(const RuntimeHandle &handle) const noexcept { return hash<uint64_t>{}(handle.value); }
+};
+}
+
+
+// Hands out RuntimeHandles, reusing the slots of released handles so slots stay dense. Thread safe.
+class RuntimeHandleAllocator {
+public:
+    RuntimeHandle allocate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t slot;
+        if (freeSlots.empty()) {
+            slot = static_cast<uint32_t>(generations.size());
+            generations.push_back(1);
+        } else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        return {static_cast<uint64_t>(generations[slot]) << 32 | slot};
+    }
+
+    // Frees the handle's slot for reuse. Releasing a stale or null handle does nothing, so a handle shared by several
+    // copies of an object may be released by each of them.
+    void release(RuntimeHandle handle) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto slot = handle.getSlot();
+        if (handle.isNull() || slot >= generations.size() || generations[slot] != handle.getGeneration()) {
+            return;
+        }
+        // Generation 0 is skipped on wrap-around, so the null handle is never allocated
+        if (++generations[slot] == 0) { generations[slot] = 1; }
+        freeSlots.push_back(slot);
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<uint32_t> generations; // Current generation of each slot
+    std::vector<uint32_t> freeSlots;
+};
+
+
+/* Per-slot state for RuntimeHandles which any thread can reach without locking. A State& stays valid for the table's
+ * lifetime (see ChunkedArray). State must be default constructible and should only hold atomics; the table doesn't
+ * know which handle currently owns a slot, so State should record that itself.
+ */
+template<typename State>
+class RuntimeHandleTable {
+public:
+    // Returns the state for the handle's slot, allocating its chunk if needed. Returns nullptr only if the slot is
+    // beyond the table's capacity (1M slots).
+    State *claim(RuntimeHandle handle) { return states.claim(handle.getSlot()); }
+
+    // Returns the state for the handle's slot, or nullptr if it has never been claimed. Never allocates.
+    State *find(RuntimeHandle handle) const { return states.find(handle.getSlot()); }
+
+private:
+    ChunkedArray<State> states;
+};
+#endif
+
+
+#ifndef ORDER_STATISTIC_LIST
+#define ORDER_STATISTIC_LIST
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <utility>
+
+/* An ordered list of unique keys which finds a key's index, and the key at an index, in O(log n), and inserts, erases
+ * and moves keys in O(log n) too. Backed by an implicit treap: each node counts the nodes below it, so an index is found
+ * by descending from the root, and a key's index by walking up from its node. Key must be hashable and cheap to copy.
+ */
+template<typename Key, typename Hash = std::hash<Key>>
+class OrderStatisticList {
+    struct Node;
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Walks the keys in order. Stays valid until the key it points at is erased - nodes never move, so inserting,
+    // moving or erasing other keys doesn't invalidate it (though a moved key is then visited from its new place).
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key *;
+        using reference = const Key &;
+
+        const_iterator() = default;
+
+        reference operator*() const { return node->key; }
+        pointer operator->() const { return &node->key; }
+
+        const_iterator &operator++() {
+            node = successor(node);
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator &other) const { return node == other.node; }
+        bool operator!=(const const_iterator &other) const { return node != other.node; }
+
+    private:
+        friend class OrderStatisticList;
+        explicit const_iterator(const Node *node): node(node) {}
+
+        const Node *node{nullptr}; // nullptr at end()
+    };
+
+    OrderStatisticList(): priorityGenerator(std::random_device{}()) {}
+
+    OrderStatisticList(const OrderStatisticList &other): OrderStatisticList() {
+        other.forEach([this](const Key &key) { insert(size(), key); });
+    }
+
+    // Deep copies other (copy-and-swap), so the two lists share no nodes
+    OrderStatisticList &operator=(OrderStatisticList other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(OrderStatisticList &other) noexcept {
+        std::swap(root, other.root);
+        nodes.swap(other.nodes);
+        std::swap(priorityGenerator, other.priorityGenerator);
+    }
+
+    [[nodiscard]] const_iterator begin() const { return const_iterator(leftmost(root)); }
+    [[nodiscard]] const_iterator end() const { return const_iterator(); }
+
+    [[nodiscard]] size_t size() const { return countOf(root); }
+
+    [[nodiscard]] bool contains(const Key &key) const { return nodes.find(key) != nodes.end(); }
+
+    // Expects index < size()
+    [[nodiscard]] const Key &at(size_t index) const {
+        const Node *node = root;
+        while (true) {
+            const auto leftCount = countOf(node->left);
+            if (index < leftCount) {
+                node = node->left;
+            } else if (index == leftCount) {
+                return node->key;
+            } else {
+                index -= leftCount + 1;
+                node = node->right;
+            }
+        }
+    }
+
+    // Returns npos if the key isn't in the list
+    [[nodiscard]] size_t indexOf(const Key &key) const {
+        const auto found = nodes.find(key);
+        if (found == nodes.end()) {
+            return npos;
+        }
+        const Node *node = found->second.get();
+        size_t index = countOf(node->left);
+        for (; node->parent != nullptr; node = node->parent) {
+            if (node == node->parent->right) {
+                index += countOf(node->parent->left) + 1;
+            }
+        }
+        return index;
+    }
+
+    // Inserts key so it ends up at index (clamped to size()). Returns false if the key is already in the list.
+    bool insert(size_t index, const Key &key) {
+        if (contains(key)) {
+            return false;
+        }
+        auto node = std::make_unique<Node>(key, priorityGenerator());
+        attach(node.get(), std::min(index, size()));
+        nodes.emplace(key, std::move(node));
+        return true;
+    }
+
+    // Returns false if the key isn't in the list
+    bool erase(const Key &key) {
+        const auto found = nodes.find(key);
+        if (found == nodes.end()) {
+            return false;
+        }
+        detach(indexOf(key));
+        nodes.erase(found);
+        return true;
+    }
+
+    // Erases the key at position, which must not be end(). Returns the iterator to the key after it.
+    const_iterator erase(const_iterator position) {
+        const const_iterator next(successor(position.node));
+        erase(*position);
+        return next;
+    }
+
+    // Moves the key at oldIndex so it ends up at newIndex, shifting the keys in between. Expects both < size().
+    void move(size_t oldIndex, size_t newIndex) {
+        if (oldIndex == newIndex) {
+            return;
+        }
+        attach(detach(oldIndex), newIndex);
+    }
+
+    void clear() {
+        root = nullptr;
+        nodes.clear();
+    }
+
+    // Calls function with each key, in order
+    template<typename Function>
+    void forEach(Function function) const {
+        forEach(root, function);
+    }
+
+private:
+    struct Node {
+        Node(const Key &key, uint32_t priority): key(key), priority(priority) {}
+
+        const Key key;
+        const uint32_t priority;
+        size_t count{1}; // Nodes in this subtree, including this one
+        Node *left{nullptr};
+        Node *right{nullptr};
+        Node *parent{nullptr};
+    };
+
+    static size_t countOf(const Node *node) { return node != nullptr ? node->count : 0; }
+
+    static const Node *leftmost(const Node *node) {
+        while (node != nullptr && node->left != nullptr) { node = node->left; }
+        return node;
+    }
+
+    // The node after node in order, or nullptr if it's the last
+    static const Node *successor(const Node *node) {
+        if (node->right != nullptr) {
+            return leftmost(node->right);
+        }
+        while (node->parent != nullptr && node == node->parent->right) {
+            node = node->parent;
+        }
+        return node->parent;
+    }
+
+    static void update(Node *node) {
+        node->count = 1 + countOf(node->left) + countOf(node->right);
+        if (node->left != nullptr) { node->left->parent = node; }
+        if (node->right != nullptr) { node->right->parent = node; }
+    }
+
+    // Splits the subtree into its first count nodes (first) and the rest (rest)
+    static void split(Node *node, size_t count, Node *&first, Node *&rest) {
+        if (node == nullptr) {
+            first = rest = nullptr;
+            return;
+        }
+        if (countOf(node->left) < count) {
+            split(node->right, count - countOf(node->left) - 1, node->right, rest);
+            first = node;
+        } else {
+            split(node->left, count, first, node->left);
+            rest = node;
+        }
+        update(node);
+    }
+
+    static Node *merge(Node *first, Node *rest) {
+        if (first == nullptr) { return rest; }
+        if (rest == nullptr) { return first; }
+        if (first->priority > rest->priority) {
+            first->right = merge(first->right, rest);
+            update(first);
+            return first;
+        }
+        rest->left = merge(first, rest->left);
+        update(rest);
+        return rest;
+    }
+
+    void setRoot(Node *newRoot) {
+        root = newRoot;
+        if (root != nullptr) { root->parent = nullptr; }
+    }
+
+    void attach(Node *node, size_t index) {
+        Node *first, *rest;
+        split(root, index, first, rest);
+        node->left = node->right = nullptr;
+        node->count = 1;
+        setRoot(merge(merge(first, node), rest));
+    }
+
+    // Unlinks (but doesn't free) the node at index
+    Node *detach(size_t index) {
+        Node *first, *middle, *rest, *node;
+        split(root, index, first, middle);
+        split(middle, 1, node, rest);
+        setRoot(merge(first, rest));
+        node->parent = nullptr;
+        return node;
+    }
+
+    template<typename Function>
+    static void forEach(const Node *node, Function &function) {
+        if (node == nullptr) { return; }
+        forEach(node->left, function);
+        function(node->key);
+        forEach(node->right, function);
+    }
+
+    Node *root{nullptr};
+    std::unordered_map<Key, std::unique_ptr<Node>, Hash> nodes; // Owns every node
+    std::mt19937 priorityGenerator;
+};
+#endif
+
 #ifndef DraggableList
 #define DraggableList
 #pragma once
@@ -607,3 +1240,116 @@ std::optional<KeyType> findKeyByValue(const std::unordered_map<KeyType, ValueTyp
 }
 
 #endif
+
+
+#ifndef WORK_STEALING_PARALLEL_FOR
+#define WORK_STEALING_PARALLEL_FOR
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// The number of workers parallelFor() uses for count indexes taken grainSize at a time: one per core, but no more than
+// there are grains. Always at least 1.
+inline size_t parallelForWorkerCount(size_t count, size_t grainSize) {
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t grains = (count + std::max<size_t>(1, grainSize) - 1) / std::max<size_t>(1, grainSize);
+    return std::max<size_t>(1, std::min(cores, grains));
+}
+
+/* Calls body(index, workerIndex) for every index in [0, count), spread over `workers` threads (the calling thread being
+ * worker 0), and returns once every call has returned. workerIndex is below `workers`, so each worker can collect
+ * results into its own slot without locking.
+ * [0, count) is split evenly between the workers up front. Each takes grainSize indexes at a time from the front of its
+ * own range, and once that is empty steals the back half of the fullest range left (the victim keeps the front), so
+ * uneven work still balances.
+ * A range is one 64-bit atomic (begin in the low half, end in the high half), so taking and stealing are each a single
+ * compare-and-swap. count must fit in 32 bits.
+ */
+template<typename Body>
+void parallelFor(size_t count, size_t grainSize, size_t workers, Body &&body) {
+    if (count == 0) {
+        return;
+    }
+    assert(static_cast<uint64_t>(count) <= 0xFFFFFFFFu); // Ranges hold 32-bit indexes
+    grainSize = std::max<size_t>(1, grainSize);
+    workers = std::max<size_t>(1, std::min(workers, count));
+    if (workers == 1) {
+        for (size_t index = 0; index < count; index++) {
+            body(index, size_t{0});
+        }
+        return;
+    }
+
+    struct alignas(64) Range { // Padded to a cache line each, so workers don't contend on each other's ranges
+        std::atomic<uint64_t> beginAndEnd{0};
+    };
+    const auto pack = [](uint64_t begin, uint64_t end) { return end << 32 | begin; };
+    const auto beginOf = [](uint64_t range) { return range & 0xFFFFFFFFu; };
+    const auto endOf = [](uint64_t range) { return range >> 32; };
+
+    std::unique_ptr<Range[]> ranges(new Range[workers]);
+    for (size_t worker = 0; worker < workers; worker++) {
+        ranges[worker].beginAndEnd.store(pack(count * worker / workers, count * (worker + 1) / workers));
+    }
+
+    const auto work = [&](size_t self) {
+        auto &own = ranges[self].beginAndEnd;
+        while (true) {
+            // Take a grain off the front of our own range
+            auto range = own.load(std::memory_order_acquire);
+            while (beginOf(range) < endOf(range)) {
+                const auto begin = beginOf(range);
+                const auto end = std::min<uint64_t>(begin + grainSize, endOf(range));
+                if (own.compare_exchange_weak(range, pack(end, endOf(range)), std::memory_order_acq_rel)) {
+                    for (auto index = begin; index < end; index++) {
+                        body(static_cast<size_t>(index), self);
+                    }
+                    range = own.load(std::memory_order_acquire);
+                }
+            }
+
+            // Out of work, so steal the back half of the fullest range left. Until the stolen range is stored in our
+            // own, it is in no range at all - but then we're the only one who needs to know about it.
+            bool stole = false;
+            while (!stole) {
+                size_t victim = workers;
+                uint64_t victimRange = 0, mostLeft = 0;
+                for (size_t other = 0; other < workers; other++) {
+                    const auto otherRange = ranges[other].beginAndEnd.load(std::memory_order_acquire);
+                    const auto left = endOf(otherRange) - std::min(beginOf(otherRange), endOf(otherRange));
+                    if (other != self && left > mostLeft) {
+                        victim = other;
+                        victimRange = otherRange;
+                        mostLeft = left;
+                    }
+                }
+                if (victim == workers) {
+                    return; // Nothing left anywhere
+                }
+                // The victim keeps [begin, middle) and we take [middle, end). Rounding down means a single index left is
+                // always taken, so a steal never comes away empty.
+                const auto middle = beginOf(victimRange) + mostLeft / 2;
+                if (ranges[victim].beginAndEnd.compare_exchange_strong(victimRange, pack(beginOf(victimRange), middle),
+                                                                       std::memory_order_acq_rel)) {
+                    own.store(pack(middle, endOf(victimRange)), std::memory_order_release);
+                    stole = true;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t worker = 1; worker < workers; worker++) {
+        threads.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto &thread: threads) {
+        thread.join();
+    }
+}
+#endif